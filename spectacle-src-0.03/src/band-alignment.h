@@ -0,0 +1,491 @@
+// CONTACT: yunheo1@illinois.edu
+
+#ifndef BAND_ALIGNMENT_H
+#define BAND_ALIGNMENT_H
+
+#include <algorithm>
+#include <string>
+
+#define SMALL_NUMBER -1000000
+#define MIN_OVERLAP  30
+
+
+
+//----------------------------------------------------------------------
+// C_alignment_penalty
+// scores of the global alignment
+// the match gain should be >= 0 and the penalties should be <= 0
+//----------------------------------------------------------------------
+struct C_alignment_penalty {
+   int  match_gain;
+   int  mismatch_penalty;
+   int  gap_opening_penalty;
+   int  gap_extension_penalty;
+   bool no_end_gap_penalty;
+};
+
+
+
+//----------------------------------------------------------------------
+// C_band_matrixes
+// match, gap 1, and gap 2 matrixes of string1 (x) and string2 (y)
+// restricted to the cells whose diagonal (x - y) is in [band_low, band_high]
+//
+// the cells of a row are stored from diagonal (band_low - 1) to (band_high + 1)
+// and the distance between two rows is one less than the number of stored diagonals
+// so (x, y - 1), (x - 1, y), and (x - 1, y - 1) are at the same relative indexes as in the full matrixes
+// and the tracebacks work without knowing the layout
+// the full matrixes are used if they are not larger than the band
+//
+// the matrixes are owned by the caller, which allocates size cells for each of them
+//----------------------------------------------------------------------
+struct C_band_matrixes {
+   int* match_matrix;
+   int* gap_1_matrix;
+   int* gap_2_matrix;
+
+   int string1_length;
+   int string2_length;
+   int band_low;
+   int band_high;
+   int width;
+   int offset;
+   int size;
+
+   // index of cell (x, y)
+   inline int index(int index_x, int index_y) const {
+      return width * index_y + index_x + offset;
+   }
+};
+
+
+
+//----------------------------------------------------------------------
+// max3
+//----------------------------------------------------------------------
+inline int max3(int a, int b, int c) {
+   int result(a);
+
+   if (b > result) {
+      result = b;
+   }
+
+   if (c > result) {
+      result = c;
+   }
+
+   return result;
+}
+
+
+
+//----------------------------------------------------------------------
+// set_band_layout
+// the band is clipped to the matrixes before the layout is chosen
+//----------------------------------------------------------------------
+inline void set_band_layout(C_band_matrixes& matrixes, int string1_length, int string2_length, int band_low, int band_high) {
+   band_low  = std::max(band_low, -string2_length);
+   band_high = std::min(band_high, string1_length);
+
+   double banded_size((band_high - band_low + 2.0) * string2_length + string1_length + 2.0 - band_low);
+
+   if (banded_size < (double)(string1_length + 1) * (string2_length + 1)) {
+      matrixes.width  = band_high - band_low + 2;
+      matrixes.offset = 1 - band_low;
+   }
+   else {
+      matrixes.width  = string1_length + 1;
+      matrixes.offset = 0;
+   }
+
+   matrixes.string1_length = string1_length;
+   matrixes.string2_length = string2_length;
+   matrixes.band_low       = band_low;
+   matrixes.band_high      = band_high;
+
+   // the bottom-right cell is the last one
+   matrixes.size = matrixes.index(string1_length, string2_length) + 1;
+}
+
+
+
+//----------------------------------------------------------------------
+// initialize_band_matrixes
+// the first row and the first column
+//----------------------------------------------------------------------
+inline void initialize_band_matrixes(const C_band_matrixes& matrixes, const C_alignment_penalty& penalty) {
+   // stored cells in the first row and the first column
+   int last_x(std::min(matrixes.string1_length, matrixes.band_high + 1));
+   int last_y(std::min(matrixes.string2_length, 1 - matrixes.band_low));
+
+   //
+   // match
+   //
+   // (0, 0)
+   matrixes.match_matrix[matrixes.index(0, 0)] = 0;
+
+   // first row
+   for(int it_x = 1; it_x <= last_x; it_x++) {
+      matrixes.match_matrix[matrixes.index(it_x, 0)] = SMALL_NUMBER;
+   }
+
+   // first column
+   for(int it_y = 1; it_y <= last_y; it_y++) {
+      matrixes.match_matrix[matrixes.index(0, it_y)] = SMALL_NUMBER;
+   }
+
+   //
+   // gap 1
+   //
+   // first row (including origin)
+   for(int it_x = 0; it_x <= last_x; it_x++) {
+      matrixes.gap_1_matrix[matrixes.index(it_x, 0)] = SMALL_NUMBER;
+   }
+
+   // first column (excluding origin)
+   for(int it_y = 1; it_y <= last_y; it_y++) {
+      if (penalty.no_end_gap_penalty) {
+         matrixes.gap_1_matrix[matrixes.index(0, it_y)] = 0;
+      }
+      else {
+         matrixes.gap_1_matrix[matrixes.index(0, it_y)] = penalty.gap_opening_penalty + it_y * penalty.gap_extension_penalty;
+      }
+   }
+
+   //
+   // gap 2
+   //
+   // first row (excluding origin)
+   for(int it_x = 1; it_x <= last_x; it_x++) {
+      if (penalty.no_end_gap_penalty) {
+         matrixes.gap_2_matrix[matrixes.index(it_x, 0)] = 0;
+      }
+      else {
+         matrixes.gap_2_matrix[matrixes.index(it_x, 0)] = penalty.gap_opening_penalty + it_x * penalty.gap_extension_penalty;
+      }
+   }
+
+   // first column (including origin)
+   for(int it_y = 0; it_y <= last_y; it_y++) {
+      matrixes.gap_2_matrix[matrixes.index(0, it_y)] = SMALL_NUMBER;
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// fill_band_matrixes
+// fill the cells in the band and return the number of them
+// the cells right outside the band are set to SMALL_NUMBER
+// so that neither the band nor the tracebacks go through them
+// the first row and the first column should be initialized before this function
+//----------------------------------------------------------------------
+inline double fill_band_matrixes(const C_band_matrixes& matrixes, const std::string& string1, const std::string& string2, const C_alignment_penalty& penalty) {
+   int* match_matrix(matrixes.match_matrix);
+   int* gap_1_matrix(matrixes.gap_1_matrix);
+   int* gap_2_matrix(matrixes.gap_2_matrix);
+
+   int string1_length(matrixes.string1_length);
+   int string2_length(matrixes.string2_length);
+   int band_low(matrixes.band_low);
+   int band_high(matrixes.band_high);
+
+   int match_penalty_tmp;
+
+   double num_cells(0.0);
+
+   for (int index_y = 0; index_y < string2_length; index_y++) {
+      int row_index(matrixes.index(1, index_y + 1));
+
+      // index_x - index_y is the diagonal of the cell
+      int index_x_begin(std::max(0, index_y + band_low));
+      int index_x_end(std::min(string1_length - 1, index_y + band_high));
+
+      if (index_x_end >= index_x_begin) {
+         num_cells += index_x_end - index_x_begin + 1;
+      }
+
+      // cells right outside the band
+      if (index_y + band_low - 1 >= 0) {
+         match_matrix[row_index + index_y + band_low - 1] = SMALL_NUMBER;
+         gap_1_matrix[row_index + index_y + band_low - 1] = SMALL_NUMBER;
+         gap_2_matrix[row_index + index_y + band_low - 1] = SMALL_NUMBER;
+      }
+
+      if (index_y + band_high + 1 < string1_length) {
+         match_matrix[row_index + index_y + band_high + 1] = SMALL_NUMBER;
+         gap_1_matrix[row_index + index_y + band_high + 1] = SMALL_NUMBER;
+         gap_2_matrix[row_index + index_y + band_high + 1] = SMALL_NUMBER;
+      }
+
+      int matrix_index(row_index + index_x_begin);
+      int index_up(matrix_index - matrixes.width);
+      int index_up_left(matrix_index - matrixes.width - 1);
+
+      // the left cells are carried over from the previous iteration
+      // instead of being read back from the matrixes
+      // g++ 12 -O3 miscompiles this loop when they are read right after being stored
+      int match_left(match_matrix[matrix_index - 1]);
+      int gap_1_left(gap_1_matrix[matrix_index - 1]);
+      int gap_2_left(gap_2_matrix[matrix_index - 1]);
+
+      for (int index_x = index_x_begin; index_x <= index_x_end; index_x++) {
+         //
+         // match
+         //
+         if (string1[index_x] == string2[index_y]) {
+            match_penalty_tmp = penalty.match_gain;
+         }
+         else {
+            match_penalty_tmp = penalty.mismatch_penalty;
+         }
+
+         match_matrix[matrix_index] = max3(
+                                            match_matrix[index_up_left] + match_penalty_tmp,
+                                            gap_1_matrix[index_up_left] + match_penalty_tmp,
+                                            gap_2_matrix[index_up_left] + match_penalty_tmp
+                                           );
+
+         //
+         // gap 1
+         //
+         // the last column in the no end gap mode
+         if (penalty.no_end_gap_penalty && (index_x == (string1_length - 1))) {
+            gap_1_matrix[matrix_index] = max3(
+                                               match_matrix[index_up],
+                                               gap_1_matrix[index_up],
+                                               gap_2_matrix[index_up]
+                                              );
+         }
+         // other columns
+         else {
+            gap_1_matrix[matrix_index] = max3(
+                                               match_matrix[index_up] + penalty.gap_opening_penalty + penalty.gap_extension_penalty,
+                                               gap_1_matrix[index_up] + penalty.gap_extension_penalty,
+                                               gap_2_matrix[index_up] + penalty.gap_opening_penalty + penalty.gap_extension_penalty
+                                              );
+         }
+
+         //
+         // gap 2
+         //
+         // the last row in the no end gap mode
+         if (penalty.no_end_gap_penalty && (index_y == (string2_length - 1))) {
+            gap_2_matrix[matrix_index] = max3(
+                                               match_left,
+                                               gap_1_left,
+                                               gap_2_left
+                                              );
+         }
+         // normal situation
+         else {
+            gap_2_matrix[matrix_index] = max3(
+                                               match_left + penalty.gap_opening_penalty + penalty.gap_extension_penalty,
+                                               gap_1_left + penalty.gap_opening_penalty + penalty.gap_extension_penalty,
+                                               gap_2_left + penalty.gap_extension_penalty
+                                              );
+         }
+
+         match_left = match_matrix[matrix_index];
+         gap_1_left = gap_1_matrix[matrix_index];
+         gap_2_left = gap_2_matrix[matrix_index];
+
+         matrix_index++;
+         index_up++;
+         index_up_left++;
+      }
+   }
+
+   return num_cells;
+}
+
+
+
+//----------------------------------------------------------------------
+// get_band_score
+// score of the best alignment (the bottom-right cell)
+//----------------------------------------------------------------------
+inline int get_band_score(const C_band_matrixes& matrixes) {
+   return max3(matrixes.match_matrix[matrixes.size - 1], matrixes.gap_1_matrix[matrixes.size - 1], matrixes.gap_2_matrix[matrixes.size - 1]);
+}
+
+
+
+//----------------------------------------------------------------------
+// traceback_band_single_path
+//
+// only one of the optimal alignments is made
+// ties are broken in the same order as traceback() in evaluate.cpp
+// 1. the matrix at the bottom-right cell: match -> gap 1 -> gap 2
+// 2. the previous matrix at each cell   : match -> gap 1 -> gap 2
+//
+// true : alignment1/2 are filled
+// false: the overlap between string1 and string2 is shorter than MIN_OVERLAP
+//        or no consistent path is found; alignment1/2 are empty
+//----------------------------------------------------------------------
+inline bool traceback_band_single_path(const C_band_matrixes& matrixes, const std::string& string1, const std::string& string2, const C_alignment_penalty& penalty, std::string& alignment1, std::string& alignment2) {
+   int* match_matrix(matrixes.match_matrix);
+   int* gap_1_matrix(matrixes.gap_1_matrix);
+   int* gap_2_matrix(matrixes.gap_2_matrix);
+
+   int string1_length(matrixes.string1_length);
+   int string2_length(matrixes.string2_length);
+   int longest_alignment_length(string1_length + string2_length);
+
+   // find out the highest alignment score
+   int highest_score(get_band_score(matrixes));
+
+   char current_matrix;
+
+   if (match_matrix[matrixes.size - 1] == highest_score) {
+      current_matrix = 'M';
+   }
+   else if (gap_1_matrix[matrixes.size - 1] == highest_score) {
+      current_matrix = '1';
+   }
+   else {
+      current_matrix = '2';
+   }
+
+   int index_x         = string1_length;
+   int index_y         = string2_length;
+   int matrix_index    = matrixes.size - 1;
+   int alignment_index = longest_alignment_length - 1;
+   int current_score   = highest_score;
+
+   alignment1.resize(longest_alignment_length);
+   alignment2.resize(longest_alignment_length);
+
+   while ((index_x > 0) && (index_y > 0)) {
+      // set penalties
+      int match_penalty_tmp;
+      int gap_1_opening_penalty(penalty.gap_opening_penalty + penalty.gap_extension_penalty);
+      int gap_2_opening_penalty(penalty.gap_opening_penalty + penalty.gap_extension_penalty);
+      int gap_1_extension_penalty(penalty.gap_extension_penalty);
+      int gap_2_extension_penalty(penalty.gap_extension_penalty);
+
+      if (string1[index_x - 1] == string2[index_y - 1]) {
+         match_penalty_tmp = penalty.match_gain;
+      }
+      else {
+         match_penalty_tmp = penalty.mismatch_penalty;
+      }
+
+      // no end gap
+      if (penalty.no_end_gap_penalty) {
+         // last column
+         if (index_x == string1_length) {
+            gap_1_opening_penalty   = 0;
+            gap_1_extension_penalty = 0;
+         }
+
+         // last row
+         if (index_y == string2_length) {
+            gap_2_opening_penalty   = 0;
+            gap_2_extension_penalty = 0;
+         }
+      }
+
+      // update alignment1/2 and indices
+      int prev_match_penalty_tmp;
+      int prev_gap_1_penalty;
+      int prev_gap_2_penalty;
+
+      switch(current_matrix) {
+         case 'M':
+            alignment1[alignment_index] = string1[index_x - 1];
+            alignment2[alignment_index] = string2[index_y - 1];
+
+            prev_match_penalty_tmp = match_penalty_tmp;
+            prev_gap_1_penalty     = match_penalty_tmp;
+            prev_gap_2_penalty     = match_penalty_tmp;
+            index_x--;
+            index_y--;
+            matrix_index -= (matrixes.width + 1);
+            break;
+
+         case '1':
+            alignment1[alignment_index] = '-';
+            alignment2[alignment_index] = string2[index_y - 1];
+
+            prev_match_penalty_tmp = gap_1_opening_penalty;
+            prev_gap_1_penalty     = gap_1_extension_penalty;
+            prev_gap_2_penalty     = gap_1_opening_penalty;
+            index_y--;
+            matrix_index -= matrixes.width;
+            break;
+
+         default:
+            alignment1[alignment_index] = string1[index_x - 1];
+            alignment2[alignment_index] = '-';
+
+            prev_match_penalty_tmp = gap_2_opening_penalty;
+            prev_gap_1_penalty     = gap_2_opening_penalty;
+            prev_gap_2_penalty     = gap_2_extension_penalty;
+            index_x--;
+            matrix_index--;
+            break;
+      }
+
+      alignment_index--;
+
+      // select the previous matrix
+      if ((match_matrix[matrix_index] + prev_match_penalty_tmp) == current_score) {
+         current_matrix = 'M';
+         current_score  = match_matrix[matrix_index];
+      }
+      else if ((gap_1_matrix[matrix_index] + prev_gap_1_penalty) == current_score) {
+         current_matrix = '1';
+         current_score  = gap_1_matrix[matrix_index];
+      }
+      else if ((gap_2_matrix[matrix_index] + prev_gap_2_penalty) == current_score) {
+         current_matrix = '2';
+         current_score  = gap_2_matrix[matrix_index];
+      }
+      // dead end: the matrixes do not have a consistent path
+      // no alignment is made, as traceback() does not record one in this case
+      else {
+         alignment1.clear();
+         alignment2.clear();
+
+         return false;
+      }
+   }
+
+   // gap in string1
+   while(index_y > 0) {
+      alignment1[alignment_index] = '-';
+      alignment2[alignment_index] = string2[index_y - 1];
+
+      alignment_index--;
+      index_y--;
+   }
+
+   // gap in string2
+   while(index_x > 0) {
+      alignment1[alignment_index] = string1[index_x - 1];
+      alignment2[alignment_index] = '-';
+
+      alignment_index--;
+      index_x--;
+   }
+
+   // too few overlaps between two sequences
+   // the number of unused characters in alignment1/2 is the length of the overlapped region
+   int start_index_tmp(alignment_index + 1);
+
+   if (start_index_tmp < MIN_OVERLAP) {
+      alignment1.clear();
+      alignment2.clear();
+
+      return false;
+   }
+
+   // remove unnecessary space in aliment1/2
+   alignment1.erase(0, start_index_tmp);
+   alignment2.erase(0, start_index_tmp);
+
+   return true;
+}
+
+#endif
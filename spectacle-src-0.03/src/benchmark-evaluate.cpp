@@ -0,0 +1,545 @@
+// CONTACT: yunheo1@illinois.edu
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "evaluate.h"
+
+// outer reference bases of each read
+#define OUTER_LENGTH_ILLUMINA 30
+#define OUTER_LENGTH_PACBIO   4000
+
+// same as the defaults of evaluate.dna
+#define MAX_CANDIDATES  30000
+#define MAX_READ_LENGTH 50000
+
+// repeats inserted into the reference windows
+#define MIN_HOMOPOLYMER_LENGTH 5
+#define MAX_HOMOPOLYMER_LENGTH 15
+#define MIN_REPEAT_UNIT_LENGTH 2
+#define MAX_REPEAT_UNIT_LENGTH 6
+#define MIN_NUM_REPEAT_UNITS   3
+#define MAX_NUM_REPEAT_UNITS   8
+
+// maximum length of an inserted sequence
+#define MAX_INSERTION_LENGTH 3
+
+
+
+//----------------------------------------------------------------------
+// synthetic read
+// errors are written in the location file format
+// index: 1-based, reference-window-based
+// an insertion is made to the right of the index
+//----------------------------------------------------------------------
+struct C_synthetic_read {
+   std::string reference;
+   std::string outer_5_end;
+   std::string outer_3_end;
+   std::string corrected_read;
+   std::string substitutions;
+   std::string insertions;
+   std::string deletions;
+
+   int original_read_length;
+};
+
+
+
+//----------------------------------------------------------------------
+// generation parameters
+//----------------------------------------------------------------------
+struct C_parameters {
+   std::size_t num_reads;
+   int         read_length;
+
+   // errors in original reads (per reference base)
+   double substitution_rate;
+   double insertion_rate;
+   double deletion_rate;
+
+   // probability that a repeat starts at a reference base
+   double repeat_rate;
+
+   // corrector behavior
+   // fixed_rate    : probability that an error is corrected (the others are unchanged)
+   // new_error_rate: probability that a new substitution is made at an error-free base
+   double fixed_rate;
+   double new_error_rate;
+
+   unsigned long long seed;
+
+   bool is_pacbio;
+};
+
+
+
+//----------------------------------------------------------------------
+// snapshot of the library metrics
+//----------------------------------------------------------------------
+struct C_metrics_snapshot {
+   std::vector<double> wall_time;
+   std::vector<double> cpu_time;
+   std::vector<double> calls;
+
+   double dp_cells;
+   double too_many_candidates;
+
+   void take() {
+      wall_time.resize(metrics_num_stages());
+      cpu_time.resize(metrics_num_stages());
+      calls.resize(metrics_num_stages());
+
+      for (int it_stage = 0; it_stage < metrics_num_stages(); it_stage++) {
+         wall_time[it_stage] = metrics_stage_wall_time(it_stage);
+         cpu_time[it_stage]  = metrics_stage_cpu_time(it_stage);
+         calls[it_stage]     = metrics_stage_calls(it_stage);
+      }
+
+      dp_cells            = metrics_dp_cells();
+      too_many_candidates = metrics_too_many_candidates();
+   }
+};
+
+
+
+enum kernel_type {KERNEL_WAVEFRONT, KERNEL_FULL_DP, KERNEL_SIMILARITY, KERNEL_BIT_PARALLEL};
+
+const char* kernel_names[] = {"wavefront", "full DP", "similarity", "bit-parallel"};
+
+
+
+void generate_reads(const C_parameters& parameters, std::vector<C_synthetic_read>& reads);
+void generate_reference(std::mt19937_64& generator, const C_parameters& parameters, const int& length, std::string& reference);
+void generate_read(std::mt19937_64& generator, const C_parameters& parameters, C_synthetic_read& read);
+void write_errors(std::vector<std::pair<std::string, std::string> >& errors, std::string& error_string);
+void run_kernel(const kernel_type& kernel, const C_parameters& parameters, const std::vector<C_synthetic_read>& reads);
+char random_base(std::mt19937_64& generator);
+char random_other_base(std::mt19937_64& generator, const char& base);
+
+
+
+int main (int argc, char** argv) {
+   // check the number of arguments
+   if (argc != 11) {
+      std::cout << std::endl << "USAGE: " << argv[0] << " <number of reads> <read length> <substitution rate> <insertion rate> <deletion rate> <repeat rate> <fixed rate> <new error rate> <seed|0> <illumina|pacbio>" << std::endl << std::endl;
+      std::cout << "     seed 0: a random seed" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   C_parameters parameters;
+
+   parameters.num_reads         = atoll(argv[1]);
+   parameters.read_length       = atoi(argv[2]);
+   parameters.substitution_rate = atof(argv[3]);
+   parameters.insertion_rate    = atof(argv[4]);
+   parameters.deletion_rate     = atof(argv[5]);
+   parameters.repeat_rate       = atof(argv[6]);
+   parameters.fixed_rate        = atof(argv[7]);
+   parameters.new_error_rate    = atof(argv[8]);
+   parameters.seed              = strtoull(argv[9], NULL, 10);
+
+   if (strcmp(argv[10], "illumina") == 0) {
+      parameters.is_pacbio = false;
+   }
+   else if (strcmp(argv[10], "pacbio") == 0) {
+      parameters.is_pacbio = true;
+   }
+   else {
+      std::cout << std::endl << "ERROR: The read type should be illumina or pacbio" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   if ((parameters.num_reads == 0) || (parameters.read_length <= 0) || (parameters.read_length > MAX_READ_LENGTH)) {
+      std::cout << std::endl << "ERROR: The number of reads should be > 0 and the read length should be in [1, " << MAX_READ_LENGTH << "]" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   if ((parameters.substitution_rate + parameters.deletion_rate > 1.0) || (parameters.insertion_rate > 1.0) || (parameters.repeat_rate > 1.0) ||
+       (parameters.fixed_rate > 1.0) || (parameters.new_error_rate > 1.0) ||
+       (parameters.substitution_rate < 0.0) || (parameters.insertion_rate < 0.0) || (parameters.deletion_rate < 0.0) ||
+       (parameters.repeat_rate < 0.0) || (parameters.fixed_rate < 0.0) || (parameters.new_error_rate < 0.0)) {
+      std::cout << std::endl << "ERROR: Rates should be in [0, 1]" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   if (parameters.seed == 0) {
+      std::random_device device;
+
+      parameters.seed = ((unsigned long long)device() << 32) | device();
+   }
+
+   //--------------------------------------------------
+   // generate reads
+   //--------------------------------------------------
+   std::vector<C_synthetic_read> reads;
+
+   generate_reads(parameters, reads);
+
+   std::cout << std::endl;
+   std::cout << "     Reads             : " << parameters.num_reads << " x " << parameters.read_length << " bp (" << argv[10] << ")" << std::endl;
+   std::cout << "     Errors            : substitution " << parameters.substitution_rate << ", insertion " << parameters.insertion_rate << ", deletion " << parameters.deletion_rate << std::endl;
+   std::cout << "     Repeats           : " << parameters.repeat_rate << std::endl;
+   std::cout << "     Corrector         : fixed " << parameters.fixed_rate << ", new errors " << parameters.new_error_rate << std::endl;
+   std::cout << "     Seed              : " << parameters.seed << std::endl;
+
+   //--------------------------------------------------
+   // run kernels
+   //--------------------------------------------------
+   run_kernel(KERNEL_WAVEFRONT,    parameters, reads);
+   run_kernel(KERNEL_FULL_DP,      parameters, reads);
+   run_kernel(KERNEL_SIMILARITY,   parameters, reads);
+   run_kernel(KERNEL_BIT_PARALLEL, parameters, reads);
+
+   std::cout << std::endl;
+}
+
+
+
+//----------------------------------------------------------------------
+// generate_reads
+//----------------------------------------------------------------------
+void generate_reads(const C_parameters& parameters, std::vector<C_synthetic_read>& reads) {
+   std::mt19937_64 generator(parameters.seed);
+
+   int outer_length(parameters.is_pacbio ? OUTER_LENGTH_PACBIO : OUTER_LENGTH_ILLUMINA);
+
+   reads.resize(parameters.num_reads);
+
+   for (std::size_t it_read = 0; it_read < parameters.num_reads; it_read++) {
+      C_synthetic_read& read = reads[it_read];
+
+      generate_reference(generator, parameters, outer_length,           read.outer_5_end);
+      generate_reference(generator, parameters, parameters.read_length, read.reference);
+      generate_reference(generator, parameters, outer_length,           read.outer_3_end);
+
+      generate_read(generator, parameters, read);
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// generate_reference
+// random bases with homopolymers and tandem repeats
+//----------------------------------------------------------------------
+void generate_reference(std::mt19937_64& generator, const C_parameters& parameters, const int& length, std::string& reference) {
+   std::uniform_real_distribution<double> probability(0.0, 1.0);
+
+   reference.clear();
+   reference.reserve(length + MAX_REPEAT_UNIT_LENGTH * MAX_NUM_REPEAT_UNITS);
+
+   while ((int)reference.length() < length) {
+      if (probability(generator) < parameters.repeat_rate) {
+         // homopolymer
+         if (probability(generator) < 0.5) {
+            std::uniform_int_distribution<int> homopolymer_length(MIN_HOMOPOLYMER_LENGTH, MAX_HOMOPOLYMER_LENGTH);
+
+            reference.append(homopolymer_length(generator), random_base(generator));
+         }
+         // tandem repeat
+         else {
+            std::uniform_int_distribution<int> unit_length(MIN_REPEAT_UNIT_LENGTH, MAX_REPEAT_UNIT_LENGTH);
+            std::uniform_int_distribution<int> num_units(MIN_NUM_REPEAT_UNITS, MAX_NUM_REPEAT_UNITS);
+
+            std::string unit;
+
+            for (int it_base = unit_length(generator); it_base > 0; it_base--) {
+               unit.push_back(random_base(generator));
+            }
+
+            for (int it_unit = num_units(generator); it_unit > 0; it_unit--) {
+               reference += unit;
+            }
+         }
+      }
+      else {
+         reference.push_back(random_base(generator));
+      }
+   }
+
+   reference.resize(length);
+}
+
+
+
+//----------------------------------------------------------------------
+// generate_read
+// errors are added to the reference window to make an original read
+// and the corrector fixes some of them and adds new substitutions
+//----------------------------------------------------------------------
+void generate_read(std::mt19937_64& generator, const C_parameters& parameters, C_synthetic_read& read) {
+   std::uniform_real_distribution<double> probability(0.0, 1.0);
+   std::uniform_int_distribution<int>     insertion_length(1, MAX_INSERTION_LENGTH);
+
+   std::vector<std::pair<std::string, std::string> > substitutions;
+   std::vector<std::pair<std::string, std::string> > insertions;
+   std::vector<std::pair<std::string, std::string> > deletions;
+
+   read.original_read_length = 0;
+   read.corrected_read.clear();
+
+   for (int it_base = 0; it_base < (int)read.reference.length(); it_base++) {
+      std::string index(std::to_string(it_base + 1));
+      char        base(read.reference[it_base]);
+
+      double error_probability(probability(generator));
+
+      // deletion
+      if (error_probability < parameters.deletion_rate) {
+         deletions.push_back(std::make_pair(index, std::string(1, base)));
+
+         // not fixed: the base is still missing
+         if (probability(generator) < parameters.fixed_rate) {
+            read.corrected_read.push_back(base);
+         }
+      }
+      // substitution
+      else if (error_probability < parameters.deletion_rate + parameters.substitution_rate) {
+         char error_base(random_other_base(generator, base));
+
+         substitutions.push_back(std::make_pair(index, std::string(1, base) + "->" + error_base));
+
+         read.original_read_length++;
+
+         if (probability(generator) < parameters.fixed_rate) {
+            read.corrected_read.push_back(base);
+         }
+         else {
+            read.corrected_read.push_back(error_base);
+         }
+      }
+      // no error
+      else {
+         read.original_read_length++;
+
+         // new error made by the corrector
+         if (probability(generator) < parameters.new_error_rate) {
+            read.corrected_read.push_back(random_other_base(generator, base));
+         }
+         else {
+            read.corrected_read.push_back(base);
+         }
+      }
+
+      // insertion to the right of this base
+      if ((it_base < (int)read.reference.length() - 1) && (probability(generator) < parameters.insertion_rate)) {
+         std::string inserted_bases;
+
+         for (int it_inserted = insertion_length(generator); it_inserted > 0; it_inserted--) {
+            inserted_bases.push_back(random_base(generator));
+         }
+
+         insertions.push_back(std::make_pair(index, inserted_bases));
+
+         read.original_read_length += inserted_bases.length();
+
+         if (probability(generator) >= parameters.fixed_rate) {
+            read.corrected_read += inserted_bases;
+         }
+      }
+   }
+
+   write_errors(substitutions, read.substitutions);
+   write_errors(insertions,    read.insertions);
+   write_errors(deletions,     read.deletions);
+}
+
+
+
+//----------------------------------------------------------------------
+// write_errors
+// <index>:<error>;<index>:<error>;...
+// the indexes are sorted as strings
+//----------------------------------------------------------------------
+void write_errors(std::vector<std::pair<std::string, std::string> >& errors, std::string& error_string) {
+   if (errors.empty() == true) {
+      error_string = "-";
+      return;
+   }
+
+   std::sort(errors.begin(), errors.end());
+
+   error_string.clear();
+
+   for (std::size_t it_error = 0; it_error < errors.size(); it_error++) {
+      error_string += errors[it_error].first + ":" + errors[it_error].second + ";";
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// run_kernel
+// every read is evaluated in the same way as evaluate.dna does
+//----------------------------------------------------------------------
+void run_kernel(const kernel_type& kernel, const C_parameters& parameters, const std::vector<C_synthetic_read>& reads) {
+   // scores
+   if (parameters.is_pacbio == true) {
+      match_gain            = 1;
+      mismatch_penalty      = -1;
+      gap_opening_penalty   = -1;
+      gap_extension_penalty = -1;
+   }
+   else {
+      match_gain            = 1;
+      mismatch_penalty      = -4;
+      gap_opening_penalty   = -6;
+      gap_extension_penalty = -1;
+   }
+
+   max_candidates     = MAX_CANDIDATES;
+   max_read_length    = MAX_READ_LENGTH;
+   is_detail          = false;
+   no_end_gap_penalty = true;
+   use_wavefront      = (kernel != KERNEL_FULL_DP);
+   ref_seq_index      = 0;
+   strand             = "+";
+
+   std::vector<int> position_vector(MAX_READ_LENGTH + 1, 0);
+   std::vector<int> corrected_position_vector(MAX_READ_LENGTH + 1, 0);
+
+   std::vector<double> latencies;
+   latencies.reserve(reads.size());
+
+   // evaluation results
+   // they should not be changed by optimizations for the same seed
+   unsigned long long checksum(0);
+
+   C_metrics_snapshot metrics_begin;
+   C_metrics_snapshot metrics_end;
+
+   metrics_begin.take();
+
+   std::chrono::steady_clock::time_point time_kernel_begin(std::chrono::steady_clock::now());
+
+   for (std::size_t it_read = 0; it_read < reads.size(); it_read++) {
+      const C_synthetic_read& read = reads[it_read];
+
+      std::chrono::steady_clock::time_point time_begin(std::chrono::steady_clock::now());
+
+      read_name     = "read" + std::to_string(it_read);
+      read_length   = read.original_read_length;
+      start_index   = 1 + OUTER_LENGTH_PACBIO;
+      end_index     = start_index + read.reference.length() - 1;
+      outer_5_end   = read.outer_5_end;
+      outer_3_end   = read.outer_3_end;
+      string1       = read.reference;
+      string2       = read.corrected_read;
+      substitutions = read.substitutions;
+      insertions    = read.insertions;
+      deletions     = read.deletions;
+
+      // same as evaluate.dna
+      // a corrected read that is shorter than the original read is regarded as a trimmed one
+      is_trimmed = (read.original_read_length > (int)read.corrected_read.length());
+
+      initialize_variables();
+
+      decode_errors();
+
+      switch (kernel) {
+         case KERNEL_WAVEFRONT:
+         case KERNEL_FULL_DP:
+            fill_matrixes();
+            find_best_alignment(&position_vector[0], &corrected_position_vector[0]);
+
+            if (too_many_candidates == false) {
+               checksum += num_yyns_substitution_local_best + 3 * num_ynys_substitution_local_best + 5 * num_nyys_substitution_local_best +
+                           7 * num_nyns_substitution_local_best + 11 * num_nnns_substitution_local_best +
+                           13 * num_yyns_insertion_local_best + 17 * num_nyys_insertion_local_best + 19 * num_nyns_insertion_local_best + 23 * num_nnns_insertion_local_best +
+                           29 * num_yyns_deletion_local_best + 31 * num_nyys_deletion_local_best + 37 * num_nyns_deletion_local_best + 41 * num_nnns_deletion_local_best;
+            }
+            break;
+
+         case KERNEL_SIMILARITY:
+            fill_matrixes();
+            calculate_percent_similarity();
+
+            checksum += num_total_bases_percent_similarity + 3 * num_matched_bases_percent_similarity;
+            break;
+
+         case KERNEL_BIT_PARALLEL:
+            calculate_percent_similarity_bit_parallel();
+
+            checksum += num_total_bases_percent_similarity + 3 * num_matched_bases_percent_similarity;
+            break;
+      }
+
+      latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - time_begin).count());
+   }
+
+   double kernel_time(std::chrono::duration<double>(std::chrono::steady_clock::now() - time_kernel_begin).count());
+
+   metrics_end.take();
+
+   //--------------------------------------------------
+   // report
+   //--------------------------------------------------
+   std::sort(latencies.begin(), latencies.end());
+
+   std::size_t num_latencies(latencies.size());
+
+   std::cout << std::endl << "     Kernel: " << kernel_names[kernel] << std::endl;
+
+   printf("          Total time              : %12.3f s\n", kernel_time);
+   printf("          Reads/s                 : %12.1f\n", num_latencies / kernel_time);
+
+   for (int it_stage = 0; it_stage < metrics_num_stages(); it_stage++) {
+      double calls(metrics_end.calls[it_stage] - metrics_begin.calls[it_stage]);
+
+      if (calls > 0) {
+         printf("          %-15s wall/cpu: %12.3f s %12.3f s\n", metrics_stage_name(it_stage).c_str(), metrics_end.wall_time[it_stage] - metrics_begin.wall_time[it_stage], metrics_end.cpu_time[it_stage] - metrics_begin.cpu_time[it_stage]);
+      }
+   }
+
+   // stage 0: dp_fill
+   double dp_cells(metrics_end.dp_cells - metrics_begin.dp_cells);
+   double dp_time(metrics_end.wall_time[0] - metrics_begin.wall_time[0]);
+
+   printf("          DP cells                : %12.0f\n", dp_cells);
+   if (dp_time > 0) {
+      printf("          DP cells/s              : %12.4g\n", dp_cells / dp_time);
+   }
+
+   printf("          Latency p50/p90/p99/max : %10.1f %10.1f %10.1f %10.1f us\n",
+          latencies[num_latencies / 2],
+          latencies[std::min(num_latencies - 1, num_latencies * 90 / 100)],
+          latencies[std::min(num_latencies - 1, num_latencies * 99 / 100)],
+          latencies[num_latencies - 1]);
+
+   printf("          Too many candidates     : %12.0f\n", metrics_end.too_many_candidates - metrics_begin.too_many_candidates);
+   printf("          Result checksum         : %12llu\n", checksum);
+}
+
+
+
+//----------------------------------------------------------------------
+// random_base
+//----------------------------------------------------------------------
+char random_base(std::mt19937_64& generator) {
+   return "ACGT"[generator() & 3];
+}
+
+
+
+//----------------------------------------------------------------------
+// random_other_base
+//----------------------------------------------------------------------
+char random_other_base(std::mt19937_64& generator, const char& base) {
+   char other_base;
+
+   do {
+      other_base = random_base(generator);
+   } while (other_base == base);
+
+   return other_base;
+}
@@ -0,0 +1,269 @@
+// CONTACT: yunheo1@illinois.edu
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "evaluate.h"
+
+// length of the reference window around each read
+#define MAX_OUTER_LENGTH 200
+
+// error rate of the reads
+#define MAX_ERROR_RATE 0.15
+
+// budget of the delta vectors that forces align_bit_parallel to compute segments again
+#define SMALL_VECTOR_BYTES 1.0
+
+
+
+//----------------------------------------------------------------------
+// functions
+//----------------------------------------------------------------------
+void generate_pair(std::mt19937_64& generator, const int& max_read_length, std::string& reference, std::string& read);
+int align_naive(const std::string& reference, const std::string& read, const bool& free_end_gaps);
+bool check_alignment(const std::string& reference, const std::string& read, const bool& free_end_gaps, const int& distance, const std::string& alignment1, const std::string& alignment2);
+
+
+
+//----------------------------------------------------------------------
+// main
+//----------------------------------------------------------------------
+int main (int argc, char** argv) {
+   // check the number of arguments
+   if (argc != 4) {
+      std::cout << std::endl << "USAGE: " << argv[0] << " <number of reads> <max read length> <seed|0>" << std::endl << std::endl;
+      std::cout << "     seed 0: a random seed" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   long long int num_reads(atoll(argv[1]));
+   int max_read_length(atoi(argv[2]));
+   unsigned long long seed(strtoull(argv[3], NULL, 10));
+
+   if ((num_reads <= 0) || (max_read_length <= 0)) {
+      std::cout << std::endl << "ERROR: The number of reads and the max read length should be > 0" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   if (seed == 0) {
+      std::random_device device;
+
+      seed = ((unsigned long long)device() << 32) | device();
+   }
+
+   std::mt19937_64 generator(seed);
+
+   long long int num_alignments(0);
+   long long int num_no_alignments(0);
+   long long int num_failures(0);
+
+   for (long long int it_read = 0; it_read < num_reads; it_read++) {
+      std::string reference;
+      std::string read;
+
+      generate_pair(generator, max_read_length, reference, read);
+
+      for (int it_end = 0; it_end < 2; it_end++) {
+         bool free_end_gaps(it_end == 1);
+
+         int distance(align_naive(reference, read, free_end_gaps));
+
+         // all the columns in memory and one segment at a time
+         std::string alignment1[2];
+         std::string alignment2[2];
+         bool is_aligned[2];
+
+         for (int it_budget = 0; it_budget < 2; it_budget++) {
+            string1                       = reference;
+            string2                       = read;
+            no_end_gap_penalty            = free_end_gaps;
+            bit_parallel_max_vector_bytes = (it_budget == 0) ? 1e18 : SMALL_VECTOR_BYTES;
+
+            initialize_variables();
+
+            is_aligned[it_budget] = align_bit_parallel(alignment1[it_budget], alignment2[it_budget]);
+         }
+
+         bool is_correct(true);
+
+         if ((is_aligned[0] != is_aligned[1]) || (alignment1[0] != alignment1[1]) || (alignment2[0] != alignment2[1])) {
+            std::cout << std::endl << "     Read " << it_read << ": different alignments with and without segments" << std::endl;
+            is_correct = false;
+         }
+         else if (is_aligned[0] == false) {
+            num_no_alignments++;
+         }
+         else if (check_alignment(reference, read, free_end_gaps, distance, alignment1[0], alignment2[0]) == false) {
+            std::cout << std::endl << "     Read " << it_read << ": the alignment does not match the naive DP (distance " << distance << ")" << std::endl;
+            std::cout << alignment1[0] << std::endl << alignment2[0] << std::endl;
+            is_correct = false;
+         }
+         else {
+            num_alignments++;
+         }
+
+         if (is_correct == false) {
+            num_failures++;
+         }
+      }
+   }
+
+   std::cout << std::endl;
+   std::cout << "     Seed              : " << seed << std::endl;
+   std::cout << "     Alignments        : " << num_alignments << std::endl;
+   std::cout << "     No alignments     : " << num_no_alignments << std::endl;
+   std::cout << "     Failures          : " << num_failures << std::endl;
+   std::cout << std::endl;
+
+   if (num_failures > 0) {
+      exit(EXIT_FAILURE);
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// generate_pair
+// read: a random substring of the reference with substitutions, insertions, and deletions
+//----------------------------------------------------------------------
+void generate_pair(std::mt19937_64& generator, const int& max_read_length, std::string& reference, std::string& read) {
+   const char bases[] = "ACGT";
+
+   std::uniform_int_distribution<int> base_distribution(0, 3);
+   std::uniform_int_distribution<int> shift_distribution(1, 3);
+   std::uniform_int_distribution<int> length_distribution(1, max_read_length);
+   std::uniform_int_distribution<int> outer_distribution(0, MAX_OUTER_LENGTH);
+   std::uniform_real_distribution<double> rate_distribution(0.0, 1.0);
+
+   int read_length(length_distribution(generator));
+   int outer_length_5_end(outer_distribution(generator));
+   int outer_length_3_end(outer_distribution(generator));
+   double error_rate(rate_distribution(generator) * MAX_ERROR_RATE);
+
+   reference.clear();
+   read.clear();
+
+   for (int it = 0; it < outer_length_5_end + read_length + outer_length_3_end; it++) {
+      reference.push_back(bases[base_distribution(generator)]);
+   }
+
+   for (int it = outer_length_5_end; it < outer_length_5_end + read_length; it++) {
+      double dice(rate_distribution(generator));
+
+      // substitution
+      if (dice < error_rate / 3.0) {
+         read.push_back(bases[(strchr(bases, reference[it]) - bases + shift_distribution(generator)) % 4]);
+      }
+      // insertion
+      else if (dice < error_rate * 2.0 / 3.0) {
+         read.push_back(reference[it]);
+         read.push_back(bases[base_distribution(generator)]);
+      }
+      // deletion
+      else if (dice < error_rate) {
+      }
+      else {
+         read.push_back(reference[it]);
+      }
+   }
+
+   if (read.empty()) {
+      read.push_back(bases[base_distribution(generator)]);
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// align_naive
+// unit-cost edit distance between read and reference
+// the bases of reference before and after the aligned region are free if free_end_gaps is true
+//----------------------------------------------------------------------
+int align_naive(const std::string& reference, const std::string& read, const bool& free_end_gaps) {
+   int reference_length(reference.length());
+   int read_length(read.length());
+
+   std::vector<int> previous_row(reference_length + 1);
+   std::vector<int> current_row(reference_length + 1);
+
+   for (int it_x = 0; it_x <= reference_length; it_x++) {
+      previous_row[it_x] = free_end_gaps ? 0 : it_x;
+   }
+
+   for (int it_y = 1; it_y <= read_length; it_y++) {
+      current_row[0] = it_y;
+
+      for (int it_x = 1; it_x <= reference_length; it_x++) {
+         current_row[it_x] = std::min(std::min(previous_row[it_x] + 1, current_row[it_x - 1] + 1),
+                                      previous_row[it_x - 1] + (reference[it_x - 1] == read[it_y - 1] ? 0 : 1));
+      }
+
+      previous_row.swap(current_row);
+   }
+
+   if (free_end_gaps) {
+      return *std::min_element(previous_row.begin(), previous_row.end());
+   }
+   else {
+      return previous_row[reference_length];
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// check_alignment
+// the alignment should contain both sequences and its cost should be the naive distance
+//----------------------------------------------------------------------
+bool check_alignment(const std::string& reference, const std::string& read, const bool& free_end_gaps, const int& distance, const std::string& alignment1, const std::string& alignment2) {
+   if (alignment1.length() != alignment2.length()) {
+      return false;
+   }
+
+   std::string reference_in_alignment;
+   std::string read_in_alignment;
+
+   for (unsigned int it = 0; it < alignment1.length(); it++) {
+      if (alignment1[it] != '-') {
+         reference_in_alignment.push_back(alignment1[it]);
+      }
+
+      if (alignment2[it] != '-') {
+         read_in_alignment.push_back(alignment2[it]);
+      }
+   }
+
+   if ((reference_in_alignment != reference) || (read_in_alignment != read)) {
+      return false;
+   }
+
+   // leading and trailing gaps in the read are free if free_end_gaps is true
+   int first_column(0);
+   int last_column(alignment1.length());
+
+   if (free_end_gaps) {
+      while ((first_column < last_column) && (alignment2[first_column] == '-')) {
+         first_column++;
+      }
+
+      while ((last_column > first_column) && (alignment2[last_column - 1] == '-')) {
+         last_column--;
+      }
+   }
+
+   int cost(0);
+
+   for (int it = first_column; it < last_column; it++) {
+      if (alignment1[it] != alignment2[it]) {
+         cost++;
+      }
+   }
+
+   return cost == distance;
+}
@@ -0,0 +1,663 @@
+// CONTACT: yunheo1@illinois.edu
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <htslib/sam.h>
+
+// status of a pair
+#define STATUS_NOT_FOUND  0
+#define STATUS_MATCHED    1
+#define STATUS_MISMATCHED 2
+#define STATUS_UNALIGNED  3
+
+
+
+//----------------------------------------------------------------------
+// a pair in the location file that comes from the target genome
+//----------------------------------------------------------------------
+struct C_pair {
+   // reference sequence ids in the sam header (-1: not in the header)
+   int32_t tid_1st;
+   int32_t tid_2nd;
+
+   // 1: +, -1: -
+   int8_t strand_1st;
+   int8_t strand_2nd;
+
+   // 1-based
+   int64_t start_1st;
+   int64_t end_1st;
+   int64_t start_2nd;
+   int64_t end_2nd;
+
+   int32_t num_insertions_1st;
+   int32_t num_insertions_2nd;
+
+   uint8_t  status;
+   uint32_t num_sam_pairs;
+};
+
+
+
+//----------------------------------------------------------------------
+// one line in the location file
+//----------------------------------------------------------------------
+struct C_location_line {
+   std::string read_name;
+   bool        has_info;
+   int         genome_1_or_2;
+   std::string ref_name;
+   char        strand;
+   int64_t     position;
+   int64_t     read_length;
+   int         num_insertions;
+   int         num_deletions;
+};
+
+
+
+bool read_location_pair(std::ifstream& f_location, C_location_line& line_1st, C_location_line& line_2nd);
+void parse_location_line(const std::string& line, C_location_line& location);
+void fill_pair(const C_location_line& line_1st, const C_location_line& line_2nd, bam_hdr_t* bam_header, C_pair& pair);
+void remove_postfix(std::string& read_name, const char postfix);
+void compare_sam_pair(C_pair& pair, const bam1_t* b_1st, const bam1_t* b_2nd, const bool& strict, uint64_t& total_once_aligned_read_length);
+void add_coverage(std::vector<uint64_t>& covered, int64_t start, int64_t end);
+int  get_aligned_read_length(const bam1_t* b);
+void print_progress(const std::size_t& num_pairs);
+
+
+
+int main (int argc, char** argv) {
+   // check the number of arguments
+   if (argc != 7) {
+      std::cout << std::endl << "USAGE: " << argv[0] << " <error location file> <sam or bam file> <genome: 1|2> <Y|N: strict matching> <output alignment summary file|-> <output statistics file>" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   int genome_1_or_2(atoi(argv[3]));
+
+   if ((genome_1_or_2 != 1) && (genome_1_or_2 != 2)) {
+      std::cout << std::endl << "ERROR: The genome should be 1 or 2" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   bool strict        = (strcmp(argv[4], "Y") == 0);
+   bool write_summary = (strcmp(argv[5], "-") != 0);
+
+   // open the sam file
+   htsFile* f_sam = hts_open(argv[2], "r");
+
+   if (f_sam == NULL) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[2] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   bam_hdr_t* bam_header = sam_hdr_read(f_sam);
+
+   if (bam_header == NULL) {
+      std::cout << std::endl << "ERROR: Cannot read the header of " << argv[2] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   //--------------------------------------------------
+   // index pairs in the location file
+   //--------------------------------------------------
+   // key: <1st read name>\t<2nd read name> without /1 and /2
+   std::cout << "Indexing the location file" << std::endl;
+
+   std::ifstream f_location;
+   f_location.open(argv[1]);
+
+   if (f_location.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[1] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::vector<C_pair> pairs;
+   std::unordered_map<std::string, std::size_t> map_pair_index;
+
+   C_location_line line_1st;
+   C_location_line line_2nd;
+
+   while (read_location_pair(f_location, line_1st, line_2nd)) {
+      if ((line_1st.has_info == true) && (line_1st.genome_1_or_2 == genome_1_or_2)) {
+         C_pair pair;
+         fill_pair(line_1st, line_2nd, bam_header, pair);
+
+         std::string read_name_1st(line_1st.read_name);
+         std::string read_name_2nd(line_2nd.read_name);
+
+         remove_postfix(read_name_1st, '1');
+         remove_postfix(read_name_2nd, '2');
+
+         std::string key(read_name_1st + "\t" + read_name_2nd);
+
+         if (map_pair_index.find(key) != map_pair_index.end()) {
+            std::cout << std::endl << "ERROR: " << line_1st.read_name << " exists multiple times in " << argv[1] << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         map_pair_index[key] = pairs.size();
+         pairs.push_back(pair);
+      }
+   }
+
+   f_location.close();
+
+   std::cout << "     Indexing the location file: done" << std::endl << std::endl;
+
+   //--------------------------------------------------
+   // compare the sam records and calculate coverage
+   //--------------------------------------------------
+   // both in a single pass over the unsorted sam file
+   std::cout << "Comparing reads and calculating coverage" << std::endl;
+
+   uint64_t total_once_aligned_read_length(0);
+
+   // covered bases of each reference sequence
+   // allocated when the first read is aligned to the sequence
+   std::vector<std::vector<uint64_t> > covered_bases(bam_header->n_targets);
+   std::vector<uint64_t>               multiple_aligned_read_length(bam_header->n_targets, 0);
+
+   bam1_t* b_tmp1 = bam_init1();
+   bam1_t* b_tmp2 = bam_init1();
+
+   std::string key;
+
+   while (sam_read1(f_sam, bam_header, b_tmp1) >= 0) {
+      if (sam_read1(f_sam, bam_header, b_tmp2) < 0) {
+         std::cout << std::endl << "ERROR: The number of records in " << argv[2] << " is odd" << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+
+      bam1_t* b_1st;
+      bam1_t* b_2nd;
+
+      if (((b_tmp1->core.flag & BAM_FREAD1) != 0) && ((b_tmp2->core.flag & BAM_FREAD2) != 0)) {
+         b_1st = b_tmp1;
+         b_2nd = b_tmp2;
+      }
+      else if (((b_tmp1->core.flag & BAM_FREAD2) != 0) && ((b_tmp2->core.flag & BAM_FREAD1) != 0)) {
+         b_1st = b_tmp2;
+         b_2nd = b_tmp1;
+      }
+      else {
+         std::cout << std::endl << "ERROR: Not pair-aligned reads " << bam_get_qname(b_tmp1) << " " << bam_get_qname(b_tmp2) << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+
+      //
+      // coverage
+      //
+      // only properly aligned pairs are counted
+      bam1_t* b_both[2] = {b_1st, b_2nd};
+
+      for (int it_read = 0; it_read < 2; it_read++) {
+         const bam1_t* b = b_both[it_read];
+
+         if (((b->core.flag & BAM_FPROPER_PAIR) != 0) && ((b->core.flag & BAM_FUNMAP) == 0) && (b->core.tid >= 0)) {
+            if (covered_bases[b->core.tid].empty()) {
+               covered_bases[b->core.tid].resize((bam_header->target_len[b->core.tid] >> 6) + 1, 0);
+            }
+
+            add_coverage(covered_bases[b->core.tid], b->core.pos, std::min((int64_t)bam_endpos(b), (int64_t)bam_header->target_len[b->core.tid]));
+
+            multiple_aligned_read_length[b->core.tid] += get_aligned_read_length(b);
+         }
+      }
+
+      //
+      // comparison
+      //
+      key.assign(bam_get_qname(b_1st));
+      key.push_back('\t');
+      key.append(bam_get_qname(b_2nd));
+
+      std::unordered_map<std::string, std::size_t>::iterator it_find = map_pair_index.find(key);
+
+      // no information, different genomes
+      if (it_find == map_pair_index.end()) {
+         continue;
+      }
+
+      compare_sam_pair(pairs[it_find->second], b_1st, b_2nd, strict, total_once_aligned_read_length);
+   }
+
+   bam_destroy1(b_tmp1);
+   bam_destroy1(b_tmp2);
+   hts_close(f_sam);
+
+   std::cout << "     Comparing reads and calculating coverage: done" << std::endl << std::endl;
+
+   //--------------------------------------------------
+   // write the results in the order of the location file
+   //--------------------------------------------------
+   std::cout << "Writing the results" << std::endl;
+
+   std::ofstream f_summary;
+
+   if (write_summary == true) {
+      f_summary.open(argv[5]);
+
+      if (f_summary.is_open() == false) {
+         std::cout << std::endl << "ERROR: Cannot open " << argv[5] << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+   }
+
+   f_location.open(argv[1]);
+
+   if (f_location.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[1] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::size_t num_target_genome_pairs(0);
+   std::size_t num_non_target_genome_pairs(0);
+   std::size_t num_no_info_pairs(0);
+   std::size_t num_correctly_aligned_pairs(0);
+   std::size_t num_wrongly_aligned_pairs(0);
+   std::size_t num_unaligned_pairs(0);
+   std::size_t pair_index(0);
+
+   while (read_location_pair(f_location, line_1st, line_2nd)) {
+      std::string result;
+
+      if (line_1st.has_info == false) {
+         num_no_info_pairs++;
+         result = "NO-INFO";
+      }
+      else if (line_1st.genome_1_or_2 != genome_1_or_2) {
+         num_non_target_genome_pairs++;
+         result = "DIFF-GENOME";
+      }
+      else {
+         num_target_genome_pairs++;
+
+         const C_pair& pair = pairs[pair_index];
+         pair_index++;
+
+         if (pair.status == STATUS_MATCHED) {
+            num_correctly_aligned_pairs++;
+            result = "MATCHED";
+         }
+         else if (pair.status == STATUS_MISMATCHED) {
+            num_wrongly_aligned_pairs++;
+            result = "MISMATCHED";
+         }
+         else {
+            num_unaligned_pairs++;
+            result = "UNALIGNED";
+         }
+      }
+
+      if (write_summary == true) {
+         f_summary << line_1st.read_name << " " << line_2nd.read_name << " " << result << "\n";
+      }
+
+      print_progress(num_target_genome_pairs + num_non_target_genome_pairs + num_no_info_pairs);
+   }
+
+   f_location.close();
+
+   if (write_summary == true) {
+      f_summary.close();
+   }
+
+   //--------------------------------------------------
+   // write statistics
+   //--------------------------------------------------
+   // pairs <A> <B> <C> <D> <E> <F> <once aligned read length>
+   // chr <name> <length> <uncovered length> <multiple aligned read length>
+   std::ofstream f_stat;
+   f_stat.open(argv[6]);
+
+   if (f_stat.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[6] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   f_stat << "pairs "
+          << num_target_genome_pairs     << " "
+          << num_non_target_genome_pairs << " "
+          << num_no_info_pairs           << " "
+          << num_correctly_aligned_pairs << " "
+          << num_wrongly_aligned_pairs   << " "
+          << num_unaligned_pairs         << " "
+          << total_once_aligned_read_length << "\n";
+
+   for (int it_tid = 0; it_tid < bam_header->n_targets; it_tid++) {
+      uint64_t length(bam_header->target_len[it_tid]);
+      uint64_t num_covered_bases(0);
+
+      for (std::size_t it_word = 0; it_word < covered_bases[it_tid].size(); it_word++) {
+         num_covered_bases += __builtin_popcountll(covered_bases[it_tid][it_word]);
+      }
+
+      f_stat << "chr "
+             << bam_header->target_name[it_tid] << " "
+             << length                          << " "
+             << length - num_covered_bases      << " "
+             << multiple_aligned_read_length[it_tid] << "\n";
+   }
+
+   f_stat.close();
+
+   bam_hdr_destroy(bam_header);
+
+   std::cout << "     Writing the results: done" << std::endl << std::endl;
+}
+
+
+
+//----------------------------------------------------------------------
+// read_location_pair
+//----------------------------------------------------------------------
+bool read_location_pair(std::ifstream& f_location, C_location_line& line_1st, C_location_line& line_2nd) {
+   std::string line;
+
+   if (!getline(f_location, line)) {
+      return false;
+   }
+
+   parse_location_line(line, line_1st);
+
+   if (!getline(f_location, line)) {
+      std::cout << std::endl << "ERROR: Fail to get the next line of " << line_1st.read_name << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   parse_location_line(line, line_2nd);
+
+   if (line_1st.has_info != line_2nd.has_info) {
+      std::cout << std::endl << "ERROR: Only one of " << line_1st.read_name << " and " << line_2nd.read_name << " has the location information" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   if ((line_1st.has_info == true) && (line_1st.genome_1_or_2 != line_2nd.genome_1_or_2)) {
+      std::cout << std::endl << "ERROR: " << line_1st.read_name << " and " << line_2nd.read_name << " come from different genomes" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   return true;
+}
+
+
+
+//----------------------------------------------------------------------
+// parse_location_line
+//----------------------------------------------------------------------
+// <read name> <ref 1 or 2> <ref name> <strand> <start index> <read length> <substitutions> <insertions> <deletions>
+// <read name> N/A
+void parse_location_line(const std::string& line, C_location_line& location) {
+   std::istringstream iss_line(line);
+
+   std::string genome;
+
+   if (!(iss_line >> location.read_name >> genome)) {
+      std::cout << std::endl << "ERROR: " << line << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   if (genome == "N/A") {
+      location.has_info = false;
+      return;
+   }
+
+   std::string strand;
+   std::string substitutions;
+   std::string insertions;
+   std::string deletions;
+
+   if ((!(iss_line >> location.ref_name >> strand >> location.position >> location.read_length >> substitutions >> insertions >> deletions)) ||
+       ((genome != "1") && (genome != "2")) ||
+       ((strand != "+") && (strand != "-"))) {
+      std::cout << std::endl << "ERROR: " << line << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   location.has_info      = true;
+   location.genome_1_or_2 = genome[0] - '0';
+   location.strand        = strand[0];
+
+   // insertions
+   // <index>:<bases>;
+   location.num_insertions = 0;
+
+   if (insertions != "-") {
+      std::size_t colon_index(insertions.find(':'));
+
+      while (colon_index != std::string::npos) {
+         std::size_t semicolon_index(insertions.find(';', colon_index));
+
+         if (semicolon_index == std::string::npos) {
+            break;
+         }
+
+         location.num_insertions += semicolon_index - colon_index - 1;
+
+         colon_index = insertions.find(':', semicolon_index);
+      }
+   }
+
+   // deletions
+   // <index>:<base>;
+   location.num_deletions = 0;
+
+   if (deletions != "-") {
+      std::size_t colon_index(deletions.find(':'));
+
+      while (colon_index != std::string::npos) {
+         std::size_t semicolon_index(deletions.find(';', colon_index));
+
+         if (semicolon_index == std::string::npos) {
+            break;
+         }
+
+         if ((semicolon_index - colon_index - 1) != 1) {
+            std::cout << std::endl << "ERROR: A multiple length deletion exists in " << location.read_name << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         location.num_deletions++;
+
+         colon_index = deletions.find(':', semicolon_index);
+      }
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// fill_pair
+//----------------------------------------------------------------------
+void fill_pair(const C_location_line& line_1st, const C_location_line& line_2nd, bam_hdr_t* bam_header, C_pair& pair) {
+   if ((line_1st.strand == '+') && (line_2nd.strand == '-')) {
+      pair.strand_1st = 1;
+      pair.strand_2nd = -1;
+   }
+   else if ((line_1st.strand == '-') && (line_2nd.strand == '+')) {
+      pair.strand_1st = -1;
+      pair.strand_2nd = 1;
+   }
+   else {
+      std::cout << std::endl << "ERROR: Irregular strand in " << line_1st.read_name << " and " << line_2nd.read_name << " (" << line_1st.strand << " " << line_2nd.strand << ")" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   pair.tid_1st = bam_name2id(bam_header, line_1st.ref_name.c_str());
+   pair.tid_2nd = bam_name2id(bam_header, line_2nd.ref_name.c_str());
+
+   // start_index: 5'-end side of the + strand
+   // end_index  : 3'-end side of the + strand
+   pair.start_1st = line_1st.position;
+   pair.start_2nd = line_2nd.position;
+   pair.end_1st   = line_1st.position + (line_1st.read_length - 1) - line_1st.num_insertions + line_1st.num_deletions;
+   pair.end_2nd   = line_2nd.position + (line_2nd.read_length - 1) - line_2nd.num_insertions + line_2nd.num_deletions;
+
+   pair.num_insertions_1st = line_1st.num_insertions;
+   pair.num_insertions_2nd = line_2nd.num_insertions;
+
+   pair.status        = STATUS_NOT_FOUND;
+   pair.num_sam_pairs = 0;
+}
+
+
+
+//----------------------------------------------------------------------
+// remove_postfix
+//----------------------------------------------------------------------
+// remove "/1" or "/2"
+void remove_postfix(std::string& read_name, const char postfix) {
+   std::size_t read_name_length(read_name.length());
+
+   if (read_name_length >= 3) {
+      if ((read_name[read_name_length - 2] == '/') && (read_name[read_name_length - 1] == postfix)) {
+         read_name.erase(read_name_length - 2, 2);
+      }
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// compare_sam_pair
+//----------------------------------------------------------------------
+// compare one of the sam records of a pair with its location
+// the first matched record in the sam file is used
+void compare_sam_pair(C_pair& pair, const bam1_t* b_1st, const bam1_t* b_2nd, const bool& strict, uint64_t& total_once_aligned_read_length) {
+   pair.num_sam_pairs++;
+
+   // pairwise aligned reads
+   if (((b_1st->core.flag & BAM_FPROPER_PAIR) != 0) && ((b_2nd->core.flag & BAM_FPROPER_PAIR) != 0)) {
+      if ((pair.status == STATUS_MATCHED) || (pair.status == STATUS_UNALIGNED)) {
+         if (pair.status == STATUS_UNALIGNED) {
+            std::cout << std::endl << "ERROR: Multiple lines with unaligned reads " << bam_get_qname(b_1st) << " " << bam_get_qname(b_2nd) << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         return;
+      }
+
+      pair.status = STATUS_MISMATCHED;
+
+      int8_t strand_1st(((b_1st->core.flag & BAM_FREVERSE) != 0) ? -1 : 1);
+      int8_t strand_2nd(((b_2nd->core.flag & BAM_FREVERSE) != 0) ? -1 : 1);
+
+      // stands and reference sequences and matched
+      if ((strand_1st != pair.strand_1st) || (strand_2nd != pair.strand_2nd) || (b_1st->core.tid != pair.tid_1st) || (b_2nd->core.tid != pair.tid_2nd)) {
+         return;
+      }
+
+      // 1-based
+      int64_t start_1st(b_1st->core.pos + 1);
+      int64_t start_2nd(b_2nd->core.pos + 1);
+      int64_t end_1st(bam_endpos(b_1st));
+      int64_t end_2nd(bam_endpos(b_2nd));
+
+      // compare the ranges
+      // the start point may become smaller when an insertion is corrected
+      // deletions do not increase the range
+      bool matched;
+
+      if (strict == true) {
+         matched = (start_1st == pair.start_1st) && (end_1st == pair.end_1st) &&
+                   (start_2nd == pair.start_2nd) && (end_2nd == pair.end_2nd);
+      }
+      else {
+         matched = (start_1st >= (pair.start_1st - pair.num_insertions_1st)) && (end_1st <= (pair.end_1st + pair.num_insertions_1st)) &&
+                   (start_2nd >= (pair.start_2nd - pair.num_insertions_2nd)) && (end_2nd <= (pair.end_2nd + pair.num_insertions_2nd));
+      }
+
+      if (matched == true) {
+         pair.status = STATUS_MATCHED;
+
+         total_once_aligned_read_length += get_aligned_read_length(b_1st) + get_aligned_read_length(b_2nd);
+      }
+   }
+   // not pairwise aligned reads
+   else {
+      if (pair.num_sam_pairs != 1) {
+         std::cout << std::endl << "ERROR: Multiple lines with unaligned reads " << bam_get_qname(b_1st) << " " << bam_get_qname(b_2nd) << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+
+      pair.status = STATUS_UNALIGNED;
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// add_coverage
+//----------------------------------------------------------------------
+// mark [start, end) (0-based) as covered
+void add_coverage(std::vector<uint64_t>& covered, int64_t start, int64_t end) {
+   if (start >= end) {
+      return;
+   }
+
+   std::size_t first_word(start >> 6);
+   std::size_t last_word((end - 1) >> 6);
+
+   uint64_t first_mask(~0ULL << (start & 63));
+   uint64_t last_mask(~0ULL >> (63 - ((end - 1) & 63)));
+
+   if (first_word == last_word) {
+      covered[first_word] |= (first_mask & last_mask);
+   }
+   else {
+      covered[first_word] |= first_mask;
+
+      for (std::size_t it_word = first_word + 1; it_word < last_word; it_word++) {
+         covered[it_word] = ~0ULL;
+      }
+
+      covered[last_word] |= last_mask;
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// get_aligned_read_length
+//----------------------------------------------------------------------
+// number of read bases in the alignment (soft clipped bases are not included)
+int get_aligned_read_length(const bam1_t* b) {
+   const uint32_t* cigar = bam_get_cigar(b);
+
+   int aligned_read_length(0);
+
+   for (uint32_t it_cigar = 0; it_cigar < b->core.n_cigar; it_cigar++) {
+      int op(bam_cigar_op(cigar[it_cigar]));
+
+      if ((op == BAM_CMATCH) || (op == BAM_CINS) || (op == BAM_CEQUAL) || (op == BAM_CDIFF)) {
+         aligned_read_length += bam_cigar_oplen(cigar[it_cigar]);
+      }
+   }
+
+   return aligned_read_length;
+}
+
+
+
+//----------------------------------------------------------------------
+// print_progress
+//----------------------------------------------------------------------
+void print_progress(const std::size_t& num_pairs) {
+   if ((num_pairs % 100000) == 0) {
+      char buffer[64];
+      snprintf(buffer, sizeof(buffer), "     %12zu pairs are processed", num_pairs);
+
+      std::cout << buffer << std::endl;
+   }
+}
@@ -0,0 +1,953 @@
+// CONTACT: yunheo1@illinois.edu
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <stdint.h>
+#include <htslib/sam.h>
+#include <htslib/faidx.h>
+
+// number of alignments decoded by the reader thread at a time
+#define READ_BATCH_SIZE 10000
+
+// maximum number of decoded batches waiting to be converted
+#define MAX_QUEUED_BATCHES 4
+
+
+
+//----------------------------------------------------------------------
+// alignments decoded by the reader thread
+// the bam file is decompressed and decoded in the reader thread
+// while the main thread converts the previous batches
+//----------------------------------------------------------------------
+class C_bam_queue {
+   private:
+      htsFile*   f_bam;
+      bam_hdr_t* bam_header;
+
+      std::deque<std::vector<bam1_t*> > batches;
+      std::vector<bam1_t*>              free_alignments;
+
+      std::mutex              queue_mutex;
+      std::condition_variable queue_cond;
+
+      std::thread reader;
+
+      bool reader_done;
+
+      std::vector<bam1_t*> prev_batch;
+      std::vector<bam1_t*> current_batch;
+      std::size_t          current_index;
+
+      void read_bam();
+      bool next_batch();
+
+   public:
+      C_bam_queue(htsFile* in_f_bam, bam_hdr_t* in_bam_header);
+      ~C_bam_queue();
+
+      bam1_t* next();
+};
+
+
+
+//----------------------------------------------------------------------
+// one aligned read converted to a line in a location file
+//----------------------------------------------------------------------
+struct C_location {
+   std::string read_name;
+   std::string ref_name;
+   char        strand;
+   int         start_index;
+   int         read_length;
+   std::string list_substitutions;
+   std::string list_insertions;
+   std::string list_deletions;
+   std::string error_free_seq;
+};
+
+
+
+//----------------------------------------------------------------------
+// conversion options and statistics
+//----------------------------------------------------------------------
+class C_converter {
+   private:
+      bam_hdr_t* bam_header;
+      faidx_t*   ref_index;
+
+      bool softclip;
+
+      // reference sequences loaded so far
+      std::vector<std::string> ref_seqs;
+      std::vector<bool>        ref_loaded;
+
+      const std::string& get_reference(const int& tid);
+
+   public:
+      std::size_t total_num_substitutions;
+      std::size_t total_num_insertions;
+      std::size_t total_num_deletions;
+      std::size_t total_num_insertions_merged;
+      std::size_t total_num_deletions_merged;
+
+      C_converter(bam_hdr_t* in_bam_header, faidx_t* in_ref_index, const bool& in_softclip);
+
+      void count_merged_errors(const bam1_t* b, const bool& count_softclip);
+      bool is_writable(const bam1_t* b);
+      void extract_error_location(const bam1_t* b, C_location& location);
+};
+
+
+
+void check_primary(const bam1_t* b);
+char get_strand(const bam1_t* b);
+void write_location(std::ofstream& f_location, const C_location& location);
+void write_error_free_read(std::ofstream& f_fasta, const C_location& location, const bool& error_free);
+void reverse_complement(std::string& sequence);
+
+
+
+int main (int argc, char** argv) {
+   // check the number of arguments
+   if ((argc != 8) && (argc != 9)) {
+      std::cout << std::endl << "USAGE: " << argv[0] << " <bam file> <single|paired> <Y|N: error-free reads> <Y|N: soft clipping -> insertions> <output location file> <output error-free fasta file 1> <output error-free fasta file 2|-> [reference fasta]" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   bool paired;
+
+   if (strcmp(argv[2], "paired") == 0) {
+      paired = true;
+   }
+   else if (strcmp(argv[2], "single") == 0) {
+      paired = false;
+   }
+   else {
+      std::cout << std::endl << "ERROR: The read type should be single or paired" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   bool error_free = (strcmp(argv[3], "Y") == 0);
+   bool softclip   = (strcmp(argv[4], "Y") == 0);
+
+   // open the bam file
+   htsFile* f_bam = hts_open(argv[1], "r");
+
+   if (f_bam == NULL) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[1] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   bam_hdr_t* bam_header = sam_hdr_read(f_bam);
+
+   if (bam_header == NULL) {
+      std::cout << std::endl << "ERROR: Cannot read the header of " << argv[1] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   // open the reference sequence
+   // the index is built if it does not exist
+   faidx_t* ref_index = NULL;
+
+   if (argc == 9) {
+      ref_index = fai_load(argv[8]);
+
+      if (ref_index == NULL) {
+         std::cout << std::endl << "ERROR: Cannot open " << argv[8] << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+   }
+
+   // open the output files
+   std::ofstream f_location;
+   std::ofstream f_fasta1;
+   std::ofstream f_fasta2;
+
+   f_location.open(argv[5]);
+
+   if (f_location.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[5] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   f_fasta1.open(argv[6]);
+
+   if (f_fasta1.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[6] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   if (paired == true) {
+      f_fasta2.open(argv[7]);
+
+      if (f_fasta2.is_open() == false) {
+         std::cout << std::endl << "ERROR: Cannot open " << argv[7] << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+   }
+
+   C_converter converter(bam_header, ref_index, softclip);
+
+   C_location location1;
+   C_location location2;
+
+   std::string prev_pair_name;
+
+   //--------------------------------------------------
+   // iterate alignments
+   //--------------------------------------------------
+   {
+      C_bam_queue bam_queue(f_bam, bam_header);
+
+      bam1_t* alignment1;
+
+      while ((alignment1 = bam_queue.next()) != NULL) {
+         // unaligned reads are filled with N/A later
+         if ((paired == false) && (alignment1->core.flag & BAM_FUNMAP)) {
+            continue;
+         }
+
+         // only the first alignment of each read (pair) is processed
+         std::string read_name1(bam_get_qname(alignment1));
+
+         if (read_name1 == prev_pair_name) {
+            continue;
+         }
+
+         prev_pair_name = read_name1;
+
+         //--------------------------------------------------
+         // single-end reads
+         //--------------------------------------------------
+         if (paired == false) {
+            check_primary(alignment1);
+
+            // soft clippings are counted as insertions when they are converted
+            converter.count_merged_errors(alignment1, true);
+
+            if (converter.is_writable(alignment1) == true) {
+               converter.extract_error_location(alignment1, location1);
+
+               write_location(f_location, location1);
+               write_error_free_read(f_fasta1, location1, error_free);
+            }
+
+            continue;
+         }
+
+         //--------------------------------------------------
+         // paired-end reads
+         //--------------------------------------------------
+         bam1_t* alignment2 = bam_queue.next();
+
+         if (alignment2 == NULL) {
+            std::cout << std::endl << "ERROR: The number of reads is " << argv[1] << " is not even" << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         std::string read_name2(bam_get_qname(alignment2));
+
+         // both reads have the same name?
+         if (read_name1 != read_name2) {
+            std::cout << std::endl << "ERROR: Read name mismatch " << read_name1 << " " << read_name2 << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         // both reads in the pair are aligned?
+         if ((alignment1->core.flag & BAM_FPROPER_PAIR) == 0) {
+            std::cout << std::endl << "ERROR: " << read_name1 << " is not in an aligned pair" << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         if ((alignment2->core.flag & BAM_FPROPER_PAIR) == 0) {
+            std::cout << std::endl << "ERROR: " << read_name2 << " is not in an aligned pair" << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         check_primary(alignment1);
+         check_primary(alignment2);
+
+         // check strand
+         if (get_strand(alignment1) == get_strand(alignment2)) {
+            std::cout << std::endl << "ERROR: Illegal strand combination " << read_name1 << " and " << read_name2 << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         // first or second read?
+         bam1_t* first_read;
+         bam1_t* second_read;
+
+         if ((alignment1->core.flag & BAM_FREAD1) && (alignment2->core.flag & BAM_FREAD2)) {
+            first_read  = alignment1;
+            second_read = alignment2;
+         }
+         else if ((alignment2->core.flag & BAM_FREAD1) && (alignment1->core.flag & BAM_FREAD2)) {
+            first_read  = alignment2;
+            second_read = alignment1;
+         }
+         else {
+            std::cout << std::endl << "ERROR: " << read_name1 << " and " << read_name2 << " are not pairwise aligned" << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         // soft clippings are not counted as insertions
+         converter.count_merged_errors(alignment1, false);
+         converter.count_merged_errors(alignment2, false);
+
+         if ((converter.is_writable(alignment1) == true) && (converter.is_writable(alignment2) == true)) {
+            converter.extract_error_location(first_read, location1);
+            converter.extract_error_location(second_read, location2);
+
+            write_location(f_location, location1);
+            write_location(f_location, location2);
+
+            // the forward error-free file is needed even without error-free reads
+            // for reordering
+            write_error_free_read(f_fasta1, location1, error_free);
+
+            if (error_free == true) {
+               write_error_free_read(f_fasta2, location2, error_free);
+            }
+         }
+      }
+   }
+
+   f_location.close();
+   f_fasta1.close();
+
+   if (paired == true) {
+      f_fasta2.close();
+   }
+
+   if (ref_index != NULL) {
+      fai_destroy(ref_index);
+   }
+
+   bam_hdr_destroy(bam_header);
+   hts_close(f_bam);
+
+   // total number of errors
+   printf("     Total number of substitutions         : %11zu\n", converter.total_num_substitutions);
+   printf("     Total number of insertions            : %11zu\n", converter.total_num_insertions_merged);
+   printf("     Total number of deletions             : %11zu\n", converter.total_num_deletions_merged);
+   printf("     Total number of insertions (separated): %11zu\n", converter.total_num_insertions);
+   printf("     Total number of deletions (separated) : %11zu\n", converter.total_num_deletions);
+}
+
+
+
+//----------------------------------------------------------------------
+// check_primary
+//----------------------------------------------------------------------
+void check_primary(const bam1_t* b) {
+   if (b->core.flag & BAM_FSECONDARY) {
+      std::cout << std::endl << "ERROR: " << bam_get_qname(b) << " is not a primary alignement" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// get_strand
+//----------------------------------------------------------------------
+char get_strand(const bam1_t* b) {
+   if (bam_is_rev(b)) {
+      return '-';
+   }
+   else {
+      return '+';
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// write_location
+// <read name> <ref 1 or 2> <ref name> <strand> <start index> <read length> <substitutions> <insertions> <deletions>
+// <ref 1 or 2>: always 1 for the reads not generate using pIRS
+//----------------------------------------------------------------------
+void write_location(std::ofstream& f_location, const C_location& location) {
+   f_location << location.read_name << " 1 "
+              << location.ref_name << " "
+              << location.strand << " "
+              << location.start_index << " "
+              << location.read_length << " "
+              << location.list_substitutions << " "
+              << location.list_insertions << " "
+              << location.list_deletions << "\n";
+}
+
+
+
+//----------------------------------------------------------------------
+// write_error_free_read
+// only the header is written without error-free reads
+//----------------------------------------------------------------------
+void write_error_free_read(std::ofstream& f_fasta, const C_location& location, const bool& error_free) {
+   f_fasta << ">" << location.read_name << "\n";
+
+   if (error_free == true) {
+      f_fasta << location.error_free_seq << "\n";
+   }
+   else {
+      f_fasta << "\n";
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// reverse_complement
+// characters other than A, C, G, and T are not changed
+//----------------------------------------------------------------------
+void reverse_complement(std::string& sequence) {
+   std::size_t length = sequence.length();
+
+   for (std::size_t it_base = 0; it_base < length / 2; it_base++) {
+      std::swap(sequence[it_base], sequence[length - it_base - 1]);
+   }
+
+   for (std::size_t it_base = 0; it_base < length; it_base++) {
+      switch (sequence[it_base]) {
+         case 'A' :
+            sequence[it_base] = 'T';
+            break;
+         case 'C' :
+            sequence[it_base] = 'G';
+            break;
+         case 'G' :
+            sequence[it_base] = 'C';
+            break;
+         case 'T' :
+            sequence[it_base] = 'A';
+            break;
+      }
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// C_bam_queue::C_bam_queue
+//----------------------------------------------------------------------
+C_bam_queue::C_bam_queue(htsFile* in_f_bam, bam_hdr_t* in_bam_header) :
+   f_bam(in_f_bam),
+   bam_header(in_bam_header),
+   reader_done(false),
+   current_index(0) {
+   reader = std::thread(&C_bam_queue::read_bam, this);
+}
+
+
+
+//----------------------------------------------------------------------
+// C_bam_queue::~C_bam_queue
+//----------------------------------------------------------------------
+C_bam_queue::~C_bam_queue() {
+   reader.join();
+
+   for (std::size_t it = 0; it < prev_batch.size(); it++) {
+      bam_destroy1(prev_batch[it]);
+   }
+
+   for (std::size_t it = 0; it < current_batch.size(); it++) {
+      bam_destroy1(current_batch[it]);
+   }
+
+   for (std::size_t it = 0; it < free_alignments.size(); it++) {
+      bam_destroy1(free_alignments[it]);
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// C_bam_queue::read_bam
+// runs in the reader thread
+//----------------------------------------------------------------------
+void C_bam_queue::read_bam() {
+   bool eof = false;
+
+   while (eof == false) {
+      std::vector<bam1_t*> batch;
+      batch.reserve(READ_BATCH_SIZE);
+
+      // recycle the alignments of converted batches
+      {
+         std::unique_lock<std::mutex> lock(queue_mutex);
+
+         while (batches.size() >= MAX_QUEUED_BATCHES) {
+            queue_cond.wait(lock);
+         }
+
+         while ((batch.size() < READ_BATCH_SIZE) && (free_alignments.empty() == false)) {
+            batch.push_back(free_alignments.back());
+            free_alignments.pop_back();
+         }
+      }
+
+      while (batch.size() < READ_BATCH_SIZE) {
+         batch.push_back(bam_init1());
+      }
+
+      // decode alignments
+      std::size_t num_alignments = 0;
+
+      while (num_alignments < READ_BATCH_SIZE) {
+         int return_value = sam_read1(f_bam, bam_header, batch[num_alignments]);
+
+         if (return_value < -1) {
+            std::cout << std::endl << "ERROR: Truncated bam file" << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+         else if (return_value < 0) {
+            eof = true;
+            break;
+         }
+
+         num_alignments++;
+      }
+
+      for (std::size_t it = num_alignments; it < batch.size(); it++) {
+         bam_destroy1(batch[it]);
+      }
+
+      batch.resize(num_alignments);
+
+      std::unique_lock<std::mutex> lock(queue_mutex);
+
+      if (num_alignments > 0) {
+         batches.push_back(batch);
+      }
+
+      if (eof == true) {
+         reader_done = true;
+      }
+
+      queue_cond.notify_all();
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// C_bam_queue::next_batch
+//----------------------------------------------------------------------
+bool C_bam_queue::next_batch() {
+   std::unique_lock<std::mutex> lock(queue_mutex);
+
+   // return the alignments of the batch before the current one to the reader thread
+   free_alignments.insert(free_alignments.end(), prev_batch.begin(), prev_batch.end());
+   prev_batch.clear();
+   prev_batch.swap(current_batch);
+   current_index = 0;
+
+   while ((batches.empty() == true) && (reader_done == false)) {
+      queue_cond.wait(lock);
+   }
+
+   if (batches.empty() == true) {
+      return false;
+   }
+
+   current_batch.swap(batches.front());
+   batches.pop_front();
+
+   queue_cond.notify_all();
+
+   return true;
+}
+
+
+
+//----------------------------------------------------------------------
+// C_bam_queue::next
+// the returned alignment is valid until the batch after the next one
+// is fetched, so the paired-end loop can hold two consecutive alignments
+//----------------------------------------------------------------------
+bam1_t* C_bam_queue::next() {
+   if (current_index == current_batch.size()) {
+      if (next_batch() == false) {
+         return NULL;
+      }
+   }
+
+   return current_batch[current_index++];
+}
+
+
+
+//----------------------------------------------------------------------
+// C_converter::C_converter
+//----------------------------------------------------------------------
+C_converter::C_converter(bam_hdr_t* in_bam_header, faidx_t* in_ref_index, const bool& in_softclip) :
+   bam_header(in_bam_header),
+   ref_index(in_ref_index),
+   softclip(in_softclip),
+   ref_seqs(in_bam_header->n_targets),
+   ref_loaded(in_bam_header->n_targets, false),
+   total_num_substitutions(0),
+   total_num_insertions(0),
+   total_num_deletions(0),
+   total_num_insertions_merged(0),
+   total_num_deletions_merged(0) {
+}
+
+
+
+//----------------------------------------------------------------------
+// C_converter::get_reference
+//----------------------------------------------------------------------
+const std::string& C_converter::get_reference(const int& tid) {
+   if (ref_loaded[tid] == false) {
+      const char* ref_name = bam_header->target_name[tid];
+
+      int   ref_length;
+      char* ref_seq = faidx_fetch_seq(ref_index, ref_name, 0, faidx_seq_len(ref_index, ref_name) - 1, &ref_length);
+
+      if (ref_seq == NULL) {
+         std::cout << std::endl << "ERROR: Cannot read " << ref_name << " from the reference" << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+
+      ref_seqs[tid].assign(ref_seq, ref_length);
+
+      for (std::size_t it_base = 0; it_base < ref_seqs[tid].length(); it_base++) {
+         ref_seqs[tid][it_base] = toupper(ref_seqs[tid][it_base]);
+      }
+
+      free(ref_seq);
+
+      ref_loaded[tid] = true;
+   }
+
+   return ref_seqs[tid];
+}
+
+
+
+//----------------------------------------------------------------------
+// C_converter::count_merged_errors
+// each I or D in a cigar string is counted once
+//----------------------------------------------------------------------
+void C_converter::count_merged_errors(const bam1_t* b, const bool& count_softclip) {
+   const uint32_t* cigar   = bam_get_cigar(b);
+   uint32_t        n_cigar = b->core.n_cigar;
+
+   for (uint32_t it_cigar = 0; it_cigar < n_cigar; it_cigar++) {
+      int op = bam_cigar_op(cigar[it_cigar]);
+
+      if (op == BAM_CINS) {
+         total_num_insertions_merged++;
+      }
+      else if (op == BAM_CDEL) {
+         total_num_deletions_merged++;
+      }
+      // leading and trailing soft clippings
+      else if ((op == BAM_CSOFT_CLIP) && (count_softclip == true) && (softclip == true) && ((it_cigar == 0) || (it_cigar == n_cigar - 1))) {
+         total_num_insertions_merged++;
+      }
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// C_converter::is_writable
+// no unsupported cigar operation, no N in the read
+// and no N in the corresponding reference region
+//----------------------------------------------------------------------
+bool C_converter::is_writable(const bam1_t* b) {
+   const uint32_t* cigar   = bam_get_cigar(b);
+   uint32_t        n_cigar = b->core.n_cigar;
+
+   for (uint32_t it_cigar = 0; it_cigar < n_cigar; it_cigar++) {
+      int op = bam_cigar_op(cigar[it_cigar]);
+
+      if (op == BAM_CSOFT_CLIP) {
+         // leading and trailing soft clippings become insertions
+         if ((softclip == false) || ((it_cigar != 0) && (it_cigar != n_cigar - 1))) {
+            return false;
+         }
+      }
+      else if ((op == BAM_CHARD_CLIP) || (op == BAM_CPAD) || (op == BAM_CEQUAL) || (op == BAM_CDIFF)) {
+         return false;
+      }
+   }
+
+   const uint8_t* seq = bam_get_seq(b);
+
+   for (int it_base = 0; it_base < b->core.l_qseq; it_base++) {
+      if (seq_nt16_str[bam_seqi(seq, it_base)] == 'N') {
+         return false;
+      }
+   }
+
+   if (ref_index != NULL) {
+      const std::string& ref_seq = get_reference(b->core.tid);
+
+      int end_pos = bam_endpos(b);
+
+      if ((b->core.pos < 0) || (end_pos > (int)ref_seq.length())) {
+         std::cout << std::endl << "ERROR: " << bam_get_qname(b) << " is out of " << bam_header->target_name[b->core.tid] << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+
+      if (ref_seq.find('N', b->core.pos) < (std::size_t)end_pos) {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+
+
+//----------------------------------------------------------------------
+// C_converter::extract_error_location
+//
+// insertion
+// ref : AAA---AAA
+// read: AAACCCAAA
+// output: 3:CCC; (the number of reference bases before the insertion)
+//
+// substitution
+// ref : AAAAAAA
+// read: AAAACAA
+// output: 5:A->C; (1-based)
+//
+// deletion
+// ref : AAAACAA
+// read: AAAA-AA
+// output: 5:C; (1-based)
+//
+// soft clippings are handled as insertions
+// positions are relative to the read, so reverse-strand alignments
+// are reverse complemented first
+//----------------------------------------------------------------------
+void C_converter::extract_error_location(const bam1_t* b, C_location& location) {
+   const uint32_t* cigar   = bam_get_cigar(b);
+   uint32_t        n_cigar = b->core.n_cigar;
+   const uint8_t*  seq     = bam_get_seq(b);
+
+   //--------------------------------------------------
+   // reference bases of M and D operations
+   //--------------------------------------------------
+   std::string ref_bases;
+
+   const uint8_t* md_tag = bam_aux_get(b, "MD");
+
+   if (md_tag != NULL) {
+      // read bases aligned to M operations
+      std::string matched_bases;
+      int         read_index = 0;
+
+      for (uint32_t it_cigar = 0; it_cigar < n_cigar; it_cigar++) {
+         int op     = bam_cigar_op(cigar[it_cigar]);
+         int length = bam_cigar_oplen(cigar[it_cigar]);
+
+         if (op == BAM_CMATCH) {
+            for (int it = 0; it < length; it++) {
+               matched_bases.push_back(seq_nt16_str[bam_seqi(seq, read_index + it)]);
+            }
+         }
+
+         if (bam_cigar_type(op) & 1) {
+            read_index += length;
+         }
+      }
+
+      // <number of matches> <mismatched reference base> ^<deleted reference bases>
+      const char* md          = bam_aux2Z(md_tag);
+      std::size_t match_index = 0;
+
+      while (*md != '\0') {
+         if (isdigit(*md)) {
+            std::size_t num_matches = strtoul(md, (char**)&md, 10);
+
+            if (match_index + num_matches > matched_bases.length()) {
+               std::cout << std::endl << "ERROR: Wrong MD tag in " << bam_get_qname(b) << std::endl << std::endl;
+               exit(EXIT_FAILURE);
+            }
+
+            ref_bases.append(matched_bases, match_index, num_matches);
+            match_index += num_matches;
+         }
+         else if (*md == '^') {
+            md++;
+
+            while (isalpha(*md)) {
+               ref_bases.push_back(toupper(*md));
+               md++;
+            }
+         }
+         else {
+            ref_bases.push_back(toupper(*md));
+            match_index++;
+            md++;
+         }
+      }
+   }
+   else if (ref_index != NULL) {
+      const std::string& ref_seq = get_reference(b->core.tid);
+      int                ref_pos = b->core.pos;
+
+      for (uint32_t it_cigar = 0; it_cigar < n_cigar; it_cigar++) {
+         int op     = bam_cigar_op(cigar[it_cigar]);
+         int length = bam_cigar_oplen(cigar[it_cigar]);
+
+         if ((op == BAM_CMATCH) || (op == BAM_CDEL)) {
+            ref_bases.append(ref_seq, ref_pos, length);
+         }
+
+         if (bam_cigar_type(op) & 2) {
+            ref_pos += length;
+         }
+      }
+   }
+   else {
+      std::cout << std::endl << "ERROR: " << bam_get_qname(b) << " does not have an MD tag; the reference file should be specified" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   //--------------------------------------------------
+   // padded alignment
+   //--------------------------------------------------
+   // align_ref : reference bases and "-"s for inserted bases
+   // align_read: read bases and "-"s for deleted bases
+   // reference skips are removed from both
+   std::string align_ref;
+   std::string align_read;
+
+   int         read_index = 0;
+   std::size_t ref_index_md = 0;
+
+   for (uint32_t it_cigar = 0; it_cigar < n_cigar; it_cigar++) {
+      int op     = bam_cigar_op(cigar[it_cigar]);
+      int length = bam_cigar_oplen(cigar[it_cigar]);
+
+      switch (op) {
+         case BAM_CMATCH :
+            align_ref.append(ref_bases, ref_index_md, length);
+            for (int it = 0; it < length; it++) {
+               align_read.push_back(seq_nt16_str[bam_seqi(seq, read_index + it)]);
+            }
+            ref_index_md += length;
+            read_index   += length;
+            break;
+         case BAM_CINS :
+         case BAM_CSOFT_CLIP :
+            align_ref.append(length, '-');
+            for (int it = 0; it < length; it++) {
+               align_read.push_back(seq_nt16_str[bam_seqi(seq, read_index + it)]);
+            }
+            read_index += length;
+            break;
+         case BAM_CDEL :
+            align_ref.append(ref_bases, ref_index_md, length);
+            align_read.append(length, '-');
+            ref_index_md += length;
+            break;
+      }
+   }
+
+   if (ref_index_md > ref_bases.length()) {
+      std::cout << std::endl << "ERROR: Wrong MD tag in " << bam_get_qname(b) << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   // take reverse complement if the strand is "-"
+   if (bam_is_rev(b)) {
+      reverse_complement(align_ref);
+      reverse_complement(align_read);
+   }
+
+   //--------------------------------------------------
+   // extract errors
+   //--------------------------------------------------
+   location.list_substitutions.clear();
+   location.list_insertions.clear();
+   location.list_deletions.clear();
+   location.error_free_seq.clear();
+
+   std::size_t num_substitutions = 0;
+   std::size_t num_insertions    = 0;
+   std::size_t num_deletions     = 0;
+
+   char buffer[32];
+
+   std::size_t align_length = align_ref.length();
+   std::size_t it_align     = 0;
+
+   while (it_align < align_length) {
+      // insertion
+      if (align_ref[it_align] == '-') {
+         std::size_t insertion_begin = it_align;
+
+         while ((it_align < align_length) && (align_ref[it_align] == '-')) {
+            it_align++;
+         }
+
+         sprintf(buffer, "%zu:", location.error_free_seq.length());
+         location.list_insertions += buffer;
+         location.list_insertions.append(align_read, insertion_begin, it_align - insertion_begin);
+         location.list_insertions += ";";
+
+         num_insertions += it_align - insertion_begin;
+
+         continue;
+      }
+
+      location.error_free_seq.push_back(align_ref[it_align]);
+
+      // deletion
+      if (align_read[it_align] == '-') {
+         sprintf(buffer, "%zu:%c;", location.error_free_seq.length(), align_ref[it_align]);
+         location.list_deletions += buffer;
+
+         num_deletions++;
+      }
+      // substitution
+      else if (align_ref[it_align] != align_read[it_align]) {
+         sprintf(buffer, "%zu:%c->%c;", location.error_free_seq.length(), align_ref[it_align], align_read[it_align]);
+         location.list_substitutions += buffer;
+
+         num_substitutions++;
+      }
+
+      it_align++;
+   }
+
+   if (num_substitutions == 0) {
+      location.list_substitutions = "-";
+   }
+
+   if (num_insertions == 0) {
+      location.list_insertions = "-";
+   }
+
+   if (num_deletions == 0) {
+      location.list_deletions = "-";
+   }
+
+   total_num_substitutions += num_substitutions;
+   total_num_insertions    += num_insertions;
+   total_num_deletions     += num_deletions;
+
+   location.read_name   = bam_get_qname(b);
+   location.ref_name    = bam_header->target_name[b->core.tid];
+   location.strand      = get_strand(b);
+   location.start_index = b->core.pos + 1;
+   location.read_length = b->core.l_qseq;
+}
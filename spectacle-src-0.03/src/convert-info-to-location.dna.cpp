@@ -0,0 +1,583 @@
+// CONTACT: yunheo1@illinois.edu
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include "ordered-pipeline.h"
+#include "read-file.h"
+
+// number of info lines read by the reader thread at a time
+#define INFO_BATCH_SIZE 10000
+
+
+
+//----------------------------------------------------------------------
+// a pirs info line and the fastq record of the read
+//----------------------------------------------------------------------
+struct C_info_record {
+   std::string line_info;
+   std::string line_fastq_header;
+   std::string line_fastq_sequence;
+};
+
+
+
+//----------------------------------------------------------------------
+// info records and their location lines
+//----------------------------------------------------------------------
+struct C_batch {
+   std::vector<C_info_record> records;
+   std::string                location_lines;
+};
+
+
+
+//----------------------------------------------------------------------
+// reader, worker, and writer threads
+// batches are converted in any order but written in the input order
+//----------------------------------------------------------------------
+class C_info_converter : public C_ordered_pipeline<C_batch> {
+   private:
+      boost::iostreams::filtering_istream& f_info;
+      C_read_file&                         f_fastq1;
+      C_read_file&                         f_fastq2;
+      std::ofstream&                       f_location;
+
+      bool read_batch(C_batch& batch);
+      void process_batch(C_batch& batch, const std::size_t& thread_id);
+      void write_batch(C_batch& batch);
+
+   public:
+      std::size_t num_reads;
+
+      C_info_converter(boost::iostreams::filtering_istream& in_f_info, C_read_file& in_f_fastq1, C_read_file& in_f_fastq2, std::ofstream& in_f_location, const std::size_t& in_num_threads);
+};
+
+
+
+bool split_info_line(const std::string& line_info, std::vector<std::string>& fields);
+bool is_number(const std::string& field);
+bool is_base(const char& base);
+std::size_t parse_errors(const std::string& errors, std::map<long, std::string>& map_errors, const bool& substitution);
+void convert_one_read(const C_info_record& record, std::string& location_lines);
+void write_errors(const std::map<long, std::string>& map_errors, const std::size_t& num_errors, std::string& location_lines);
+
+
+
+int main (int argc, char** argv) {
+   // check the number of arguments
+   if (argc != 6) {
+      std::cout << std::endl << "USAGE: " << argv[0] << " <pirs info file> <fastq file 1> <fastq file 2> <output location file> <number of threads|0: all cores>" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::size_t num_threads = atoi(argv[5]);
+
+   if (num_threads == 0) {
+      num_threads = std::max(1U, std::thread::hardware_concurrency());
+   }
+
+   // check whether the info file is gzipped
+   std::string in_info(argv[1]);
+
+   bool is_gzip = (in_info.length() > 3) && (in_info.compare(in_info.length() - 3, 3, ".gz") == 0);
+
+   // open the info file
+   std::ifstream f_info_raw;
+
+   if (is_gzip) {
+      f_info_raw.open(argv[1], std::ios_base::binary);
+   }
+   else {
+      f_info_raw.open(argv[1]);
+   }
+
+   if (f_info_raw.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[1] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   // set the io filter
+   boost::iostreams::filtering_istream f_info;
+
+   if (is_gzip) {
+      f_info.push(boost::iostreams::gzip_decompressor());
+   }
+
+   f_info.push(f_info_raw);
+
+   // open the fastq files
+   C_read_file f_fastq1(argv[2], true);
+   C_read_file f_fastq2(argv[3], true);
+
+   // open the location file
+   std::ofstream f_location(argv[4]);
+
+   if (f_location.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[4] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   C_info_converter converter(f_info, f_fastq1, f_fastq2, f_location, num_threads);
+
+   converter.run();
+
+   f_info_raw.close();
+   f_location.close();
+
+   std::cout << "     Number of threads: " << num_threads << std::endl;
+   printf("     Number of reads  : %12zu\n", converter.num_reads);
+}
+
+
+
+//----------------------------------------------------------------------
+// split_info_line
+// <read name> <1|2> <ref name> <start index> <+|-> <> <> <substitutions> <insertions> <deletions> ...
+// returns false if the line is not a pirs information line
+//----------------------------------------------------------------------
+bool split_info_line(const std::string& line_info, std::vector<std::string>& fields) {
+   fields.clear();
+
+   if ((line_info.empty() == true) || isspace(line_info[0])) {
+      return false;
+   }
+
+   std::size_t it_begin = 0;
+
+   while ((fields.size() < 10) && (it_begin < line_info.length())) {
+      std::size_t it_end = it_begin;
+
+      while ((it_end < line_info.length()) && (isspace(line_info[it_end]) == false)) {
+         it_end++;
+      }
+
+      fields.push_back(line_info.substr(it_begin, it_end - it_begin));
+
+      it_begin = it_end;
+
+      while ((it_begin < line_info.length()) && isspace(line_info[it_begin])) {
+         it_begin++;
+      }
+   }
+
+   if (fields.size() < 10) {
+      return false;
+   }
+
+   if ((fields[1] != "1") && (fields[1] != "2")) {
+      return false;
+   }
+
+   if (is_number(fields[3]) == false) {
+      return false;
+   }
+
+   if ((fields[4] != "+") && (fields[4] != "-")) {
+      return false;
+   }
+
+   return true;
+}
+
+
+
+//----------------------------------------------------------------------
+// is_number
+//----------------------------------------------------------------------
+bool is_number(const std::string& field) {
+   if (field.empty() == true) {
+      return false;
+   }
+
+   for (std::size_t it = 0; it < field.length(); it++) {
+      if (isdigit(field[it]) == false) {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+
+
+//----------------------------------------------------------------------
+// is_base
+//----------------------------------------------------------------------
+bool is_base(const char& base) {
+   return ((base == 'A') || (base == 'C') || (base == 'G') || (base == 'T'));
+}
+
+
+
+//----------------------------------------------------------------------
+// parse_errors
+// substitution: <index>,<org>-><err>;
+// indel       : <index>,<bases>;
+// returns the total number of the bases in the error list
+// for substitutions it is the number of distinct indexes
+//----------------------------------------------------------------------
+std::size_t parse_errors(const std::string& errors, std::map<long, std::string>& map_errors, const bool& substitution) {
+   map_errors.clear();
+
+   std::size_t num_bases = 0;
+
+   if (errors == "-") {
+      return num_bases;
+   }
+
+   std::size_t it = 0;
+
+   while (it < errors.length()) {
+      if (isdigit(errors[it]) == false) {
+         it++;
+         continue;
+      }
+
+      // index
+      std::size_t it_end = it;
+
+      while ((it_end < errors.length()) && isdigit(errors[it_end])) {
+         it_end++;
+      }
+
+      if ((it_end >= errors.length()) || (errors[it_end] != ',')) {
+         it++;
+         continue;
+      }
+
+      // bases
+      std::size_t it_bases = it_end + 1;
+      std::size_t it_bases_end;
+
+      if (substitution == true) {
+         if ((it_bases + 5 <= errors.length()) && is_base(errors[it_bases]) && (errors[it_bases + 1] == '-') && (errors[it_bases + 2] == '>') && is_base(errors[it_bases + 3]) && (errors[it_bases + 4] == ';')) {
+            it_bases_end = it_bases + 4;
+         }
+         else {
+            it++;
+            continue;
+         }
+      }
+      else {
+         it_bases_end = it_bases;
+
+         while ((it_bases_end < errors.length()) && is_base(errors[it_bases_end])) {
+            it_bases_end++;
+         }
+
+         if ((it_bases_end == it_bases) || (it_bases_end >= errors.length()) || (errors[it_bases_end] != ';')) {
+            it++;
+            continue;
+         }
+      }
+
+      std::string bases = errors.substr(it_bases, it_bases_end - it_bases);
+
+      map_errors[atol(errors.substr(it, it_end - it).c_str())] = bases;
+
+      if (substitution == false) {
+         num_bases += bases.length();
+      }
+
+      it = it_bases_end + 1;
+   }
+
+   if (substitution == true) {
+      num_bases = map_errors.size();
+   }
+
+   return num_bases;
+}
+
+
+
+//----------------------------------------------------------------------
+// write_errors
+// <index>:<error>;<index>:<error>;...
+//----------------------------------------------------------------------
+void write_errors(const std::map<long, std::string>& map_errors, const std::size_t& num_errors, std::string& location_lines) {
+   location_lines += " ";
+
+   if (num_errors == 0) {
+      location_lines += "-";
+      return;
+   }
+
+   for (std::map<long, std::string>::const_iterator it_error = map_errors.begin(); it_error != map_errors.end(); it_error++) {
+      location_lines += std::to_string(it_error->first);
+      location_lines += ":";
+      location_lines += it_error->second;
+      location_lines += ";";
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// convert_one_read
+// <read name> <ref 1 or 2> <ref name> <strand> <start index> <read length> <substitutions> <insertions> <deletions>
+//----------------------------------------------------------------------
+void convert_one_read(const C_info_record& record, std::string& location_lines) {
+   std::vector<std::string> fields;
+
+   if (split_info_line(record.line_info, fields) == false) {
+      std::cout << std::endl << "ERROR: Illegal line " << record.line_info << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   // remove "@" from read_name
+   std::string read_name(fields[0]);
+
+   if (read_name[0] == '@') {
+      read_name.erase(0, 1);
+   }
+
+   //--------------------------------------------------
+   // parse errors
+   // substitution: 3,A->C (ref AAA, read AAC)
+   // insertion   : 2,AC   (ref AA--, read AAAC), inserted to the right of the index
+   // deletion    : 2,AC   (ref AACG, read AA--), pirs bug: the index should be 3
+   //--------------------------------------------------
+   std::map<long, std::string> map_substitution;
+   std::map<long, std::string> map_insertion;
+   std::map<long, std::string> map_deletion;
+
+   std::size_t num_substitutions = parse_errors(fields[7], map_substitution, true);
+   std::size_t num_insertions    = parse_errors(fields[8], map_insertion, false);
+   std::size_t num_deletions     = parse_errors(fields[9], map_deletion, false);
+
+   //--------------------------------------------------
+   // positions in the infomation file were calculated using indexes based on the original read
+   // the indexes should be converted to the ones based on the reference sequence
+   // -1 for all the errors to the right of an insertion
+   // +1 for all the errors to the right of a deletion
+   //--------------------------------------------------
+   if (((map_insertion.size() + map_deletion.size()) > 0) && ((map_substitution.size() + map_insertion.size() + map_deletion.size()) > 1)) {
+      std::map<long, std::string> map_substitution_tmp;
+      std::map<long, std::string> map_insertion_tmp;
+      std::map<long, std::string> map_deletion_tmp;
+
+      // find the maximum index among all the errors
+      long max_index = 0;
+
+      if (num_substitutions > 0) {
+         max_index = std::max(max_index, map_substitution.rbegin()->first);
+      }
+
+      if (num_insertions > 0) {
+         max_index = std::max(max_index, map_insertion.rbegin()->first);
+      }
+
+      if (num_deletions > 0) {
+         max_index = std::max(max_index, map_deletion.rbegin()->first);
+      }
+
+      // only the indexes that have errors are visited
+      std::map<long, std::string>::const_iterator it_substitution = map_substitution.lower_bound(1);
+      std::map<long, std::string>::const_iterator it_insertion    = map_insertion.lower_bound(1);
+      std::map<long, std::string>::const_iterator it_deletion     = map_deletion.lower_bound(1);
+
+      long adjust = 0;
+
+      while (true) {
+         long index = max_index + 1;
+
+         if (it_substitution != map_substitution.end()) {
+            index = std::min(index, it_substitution->first);
+         }
+
+         if (it_insertion != map_insertion.end()) {
+            index = std::min(index, it_insertion->first);
+         }
+
+         if (it_deletion != map_deletion.end()) {
+            index = std::min(index, it_deletion->first);
+         }
+
+         if (index > max_index) {
+            break;
+         }
+
+         // when both a substitution and an insertion exist in the same index
+         // the index of the substitution is not modified
+         if ((it_substitution != map_substitution.end()) && (it_substitution->first == index)) {
+            map_substitution_tmp[index + adjust] = it_substitution->second;
+            it_substitution++;
+         }
+
+         bool has_deletion = (it_deletion != map_deletion.end()) && (it_deletion->first == index);
+
+         if ((it_insertion != map_insertion.end()) && (it_insertion->first == index)) {
+            map_insertion_tmp[index + adjust] = it_insertion->second;
+            adjust -= it_insertion->second.length();
+            it_insertion++;
+
+            // both an insertion and a deletion exist in the same index
+            if (has_deletion == true) {
+               std::cout << std::endl << "ERROR: Insertion and deletion in " << read_name << std::endl << std::endl;
+               exit(EXIT_FAILURE);
+            }
+         }
+         else if (has_deletion == true) {
+            map_deletion_tmp[index + adjust] = it_deletion->second;
+            adjust += it_deletion->second.length();
+            it_deletion++;
+         }
+      }
+
+      map_substitution.swap(map_substitution_tmp);
+      map_insertion.swap(map_insertion_tmp);
+      map_deletion.swap(map_deletion_tmp);
+   }
+
+   //--------------------------------------------------
+   // expand multiple-length deletions to multiple single-length deletions
+   // 2:AC -> 3:A, 4:C
+   // when expanded deletions overlap, the one from the larger index is kept
+   //--------------------------------------------------
+   if (map_deletion.empty() == false) {
+      std::map<long, std::string> map_deletion_tmp;
+
+      for (std::map<long, std::string>::const_iterator it_deletion = map_deletion.begin(); it_deletion != map_deletion.end(); it_deletion++) {
+         for (std::size_t it_base = 0; it_base < it_deletion->second.length(); it_base++) {
+            map_deletion_tmp[it_deletion->first + 1 + it_base] = it_deletion->second.substr(it_base, 1);
+         }
+      }
+
+      map_deletion.swap(map_deletion_tmp);
+   }
+
+   //--------------------------------------------------
+   // fastq record
+   //--------------------------------------------------
+   if ((record.line_fastq_header.length() < 2) || (record.line_fastq_header[0] != '@') || isspace(record.line_fastq_header[1])) {
+      std::cout << std::endl << "ERROR: " << record.line_fastq_header << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::size_t it_name_end = 1;
+
+   while ((it_name_end < record.line_fastq_header.length()) && (isspace(record.line_fastq_header[it_name_end]) == false)) {
+      it_name_end++;
+   }
+
+   std::string read_name_fastq = record.line_fastq_header.substr(1, it_name_end - 1);
+
+   if (read_name_fastq != read_name) {
+      std::cout << std::endl << "ERROR: Read name mismatch " << read_name_fastq << " " << read_name << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   //**************************************************
+   // THIS IS NEEDED FOR PIRS 1.10
+   //**************************************************
+   // pirs 1.10 has a bug in calculating the start indices
+   std::string start_index(fields[3]);
+
+   if (fields[4] == "-") {
+      start_index = std::to_string(atol(fields[3].c_str()) + 2 * ((long)num_insertions - (long)num_deletions));
+   }
+
+   location_lines += read_name + " " + fields[1] + " " + fields[2] + " " + fields[4] + " " + start_index + " " + std::to_string(record.line_fastq_sequence.length());
+
+   write_errors(map_substitution, num_substitutions, location_lines);
+   write_errors(map_insertion, num_insertions, location_lines);
+   write_errors(map_deletion, num_deletions, location_lines);
+
+   location_lines += "\n";
+}
+
+
+
+//----------------------------------------------------------------------
+// C_info_converter::C_info_converter
+//----------------------------------------------------------------------
+C_info_converter::C_info_converter(boost::iostreams::filtering_istream& in_f_info, C_read_file& in_f_fastq1, C_read_file& in_f_fastq2, std::ofstream& in_f_location, const std::size_t& in_num_threads) :
+   C_ordered_pipeline<C_batch>(in_num_threads),
+   f_info(in_f_info),
+   f_fastq1(in_f_fastq1),
+   f_fastq2(in_f_fastq2),
+   f_location(in_f_location),
+   num_reads(0) {
+}
+
+
+
+//----------------------------------------------------------------------
+// C_info_converter::read_batch
+// runs in the reader thread
+// the reader only cuts lines; the info lines are parsed by the worker threads
+// the fastq records are read alternately from fastq file 1 and 2
+// comment lines and empty lines in the info file are skipped
+//----------------------------------------------------------------------
+bool C_info_converter::read_batch(C_batch& batch) {
+   std::string line_info;
+
+   batch.records.reserve(INFO_BATCH_SIZE);
+
+   while (batch.records.size() < INFO_BATCH_SIZE) {
+      if (!std::getline(f_info, line_info)) {
+         break;
+      }
+
+      // comment lines and empty lines
+      if ((line_info.empty() == true) || (line_info[0] == '#')) {
+         continue;
+      }
+
+      C_info_record record;
+
+      C_read_file& f_fastq = ((num_reads % 2) == 0) ? f_fastq1 : f_fastq2;
+
+      if (f_fastq.next_read() == false) {
+         std::cout << std::endl << "ERROR: The number of reads in " << f_fastq.get_file_name() << " is smaller than that in the info file" << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+
+      record.line_fastq_header.swap(f_fastq.line_header);
+      record.line_fastq_sequence.swap(f_fastq.line_sequence);
+
+      record.line_info.swap(line_info);
+
+      batch.records.push_back(record);
+
+      num_reads++;
+   }
+
+   return (batch.records.empty() == false);
+}
+
+
+
+//----------------------------------------------------------------------
+// C_info_converter::process_batch
+// runs in each worker thread
+//----------------------------------------------------------------------
+void C_info_converter::process_batch(C_batch& batch, const std::size_t& thread_id) {
+   for (std::size_t it_record = 0; it_record < batch.records.size(); it_record++) {
+      convert_one_read(batch.records[it_record], batch.location_lines);
+   }
+
+   batch.records.clear();
+   batch.records.shrink_to_fit();
+}
+
+
+
+//----------------------------------------------------------------------
+// C_info_converter::write_batch
+// runs in the calling thread in the input order
+//----------------------------------------------------------------------
+void C_info_converter::write_batch(C_batch& batch) {
+   f_location << batch.location_lines;
+}
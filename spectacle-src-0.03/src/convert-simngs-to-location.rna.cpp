@@ -0,0 +1,500 @@
+// CONTACT: yunheo1@illinois.edu
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "ordered-pipeline.h"
+#include "band-alignment.h"
+
+// number of read pairs read by the reader thread at a time
+#define READ_BATCH_SIZE 2000
+
+// initial half width of the diagonal band
+#define INITIAL_BAND_WIDTH 16
+
+
+
+//----------------------------------------------------------------------
+// a beers read and the simngs read generated from it
+//----------------------------------------------------------------------
+struct C_read_pair {
+   std::string read_id;
+   std::string seq_beers;
+   std::string seq_simngs;
+   char        strand;
+};
+
+
+
+//----------------------------------------------------------------------
+// read pairs and their location lines
+//----------------------------------------------------------------------
+struct C_batch {
+   std::vector<C_read_pair> read_pairs;
+   std::string              location_lines;
+   std::size_t              num_substitutions;
+   std::size_t              num_insertions;
+   std::size_t              num_deletions;
+};
+
+
+
+//----------------------------------------------------------------------
+// global alignment of two reads of the same length in a diagonal band
+// the matrixes are filled and traced back by band-alignment.h
+// as fill_matrixes() and give_random_alignment() in evaluate.cpp do with no_end_gap_penalty = false
+// only the cells whose diagonal (x - y) is in [-band_width - 1, band_width + 1]
+// are stored
+//----------------------------------------------------------------------
+class C_band_aligner {
+   private:
+      const C_alignment_penalty& penalty;
+
+      // reused by all the reads of a worker thread
+      std::vector<int> match_matrix;
+      std::vector<int> gap_1_matrix;
+      std::vector<int> gap_2_matrix;
+
+      C_band_matrixes matrixes;
+
+      int length;
+      int band_width;
+
+      void fill_matrixes(const std::string& string1, const std::string& string2);
+      int  upper_bound_outside_band();
+
+   public:
+      C_band_aligner(const C_alignment_penalty& in_penalty) :
+         penalty(in_penalty) {
+      }
+
+      bool align(const std::string& string1, const std::string& string2, std::string& alignment1, std::string& alignment2);
+};
+
+
+
+//----------------------------------------------------------------------
+// reader, worker, and writer threads
+// batches are aligned in any order but written in the input order
+//----------------------------------------------------------------------
+class C_simngs_converter : public C_ordered_pipeline<C_batch> {
+   private:
+      std::ifstream& f_beers;
+      std::ifstream& f_simngs;
+      std::ofstream& f_location;
+
+      const char* beers_file_name;
+      const char* simngs_file_name;
+
+      const C_alignment_penalty& penalty;
+
+      // one aligner per worker thread
+      std::vector<C_band_aligner> aligners;
+
+      // reads read by the reader thread
+      std::size_t num_reads;
+
+      bool read_batch(C_batch& batch);
+      void process_batch(C_batch& batch, const std::size_t& thread_id);
+      void write_batch(C_batch& batch);
+      void compare_one_read(C_band_aligner& aligner, const C_read_pair& read_pair, C_batch& batch);
+
+   public:
+      std::size_t total_num_substitutions;
+      std::size_t total_num_insertions;
+      std::size_t total_num_deletions;
+
+      C_simngs_converter(std::ifstream& in_f_beers, std::ifstream& in_f_simngs, std::ofstream& in_f_location, const char* in_beers_file_name, const char* in_simngs_file_name, const C_alignment_penalty& in_penalty, const std::size_t& in_num_threads);
+};
+
+
+
+void check_sequence(std::string& sequence);
+void write_errors(std::vector<std::pair<std::string, std::string> >& errors, std::string& location_lines);
+
+
+
+int main (int argc, char** argv) {
+   // check the number of arguments
+   if (argc != 9) {
+      std::cout << std::endl << "USAGE: " << argv[0] << " <beers fasta file> <simngs fastq file> <output location file> <match gain> <mismatch penalty> <gap opening penalty> <gap extension penalty> <number of threads|0: all cores>" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   C_alignment_penalty penalty;
+
+   penalty.match_gain            = atoi(argv[4]);
+   penalty.mismatch_penalty      = atoi(argv[5]);
+   penalty.gap_opening_penalty   = atoi(argv[6]);
+   penalty.gap_extension_penalty = atoi(argv[7]);
+   penalty.no_end_gap_penalty    = false;
+
+   if ((penalty.match_gain < 0) || (penalty.mismatch_penalty > 0) || (penalty.gap_opening_penalty > 0) || (penalty.gap_extension_penalty > 0)) {
+      std::cout << std::endl << "ERROR: The match gain should be >= 0 and the penalties should be <= 0" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::size_t num_threads = atoi(argv[8]);
+
+   if (num_threads == 0) {
+      num_threads = std::max(1U, std::thread::hardware_concurrency());
+   }
+
+   // open files
+   std::ifstream f_beers(argv[1]);
+
+   if (f_beers.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[1] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::ifstream f_simngs(argv[2]);
+
+   if (f_simngs.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[2] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::ofstream f_location(argv[3]);
+
+   if (f_location.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[3] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   C_simngs_converter converter(f_beers, f_simngs, f_location, argv[1], argv[2], penalty, num_threads);
+
+   converter.run();
+
+   f_beers.close();
+   f_simngs.close();
+   f_location.close();
+
+   // total number of errors
+   std::cout << "     Number of threads: " << num_threads << std::endl;
+   std::cout << "     Number of errors in the simngs fastq file:" << std::endl;
+   printf("          Substitutions     : %12zu\n", converter.total_num_substitutions);
+   printf("          Insertions        : %12zu\n", converter.total_num_insertions);
+   printf("          Deletions         : %12zu\n", converter.total_num_deletions);
+}
+
+
+
+//----------------------------------------------------------------------
+// check_sequence
+// only A, C, G, and T are allowed after converting the sequence to upper case
+//----------------------------------------------------------------------
+void check_sequence(std::string& sequence) {
+   for (std::size_t it_base = 0; it_base < sequence.length(); it_base++) {
+      sequence[it_base] = toupper(sequence[it_base]);
+
+      switch (sequence[it_base]) {
+         case 'A':
+         case 'C':
+         case 'G':
+         case 'T':
+            break;
+         default:
+            std::cout << std::endl << "ERROR: Illegal characters exist " << sequence << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+      }
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// write_errors
+// <index>:<error>;<index>:<error>;...
+// the indexes are sorted as strings
+//----------------------------------------------------------------------
+void write_errors(std::vector<std::pair<std::string, std::string> >& errors, std::string& location_lines) {
+   if (errors.empty() == true) {
+      location_lines += " -";
+      return;
+   }
+
+   std::sort(errors.begin(), errors.end());
+
+   location_lines += " ";
+
+   for (std::size_t it_error = 0; it_error < errors.size(); it_error++) {
+      location_lines += errors[it_error].first;
+      location_lines += ":";
+      location_lines += errors[it_error].second;
+      location_lines += ";";
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// C_band_aligner::fill_matrixes
+// string1: columns (x), string2: rows (y)
+//----------------------------------------------------------------------
+void C_band_aligner::fill_matrixes(const std::string& string1, const std::string& string2) {
+   set_band_layout(matrixes, string1.length(), string2.length(), -band_width, band_width);
+
+   match_matrix.resize(matrixes.size);
+   gap_1_matrix.resize(matrixes.size);
+   gap_2_matrix.resize(matrixes.size);
+
+   matrixes.match_matrix = match_matrix.data();
+   matrixes.gap_1_matrix = gap_1_matrix.data();
+   matrixes.gap_2_matrix = gap_2_matrix.data();
+
+   initialize_band_matrixes(matrixes, penalty);
+   fill_band_matrixes(matrixes, string1, string2, penalty);
+}
+
+
+
+//----------------------------------------------------------------------
+// C_band_aligner::upper_bound_outside_band
+// any path that reaches a diagonal outside the band has at least two gaps
+// whose total length is band_width + 1 or more in each read
+// because both reads have the same length
+//----------------------------------------------------------------------
+int C_band_aligner::upper_bound_outside_band() {
+   return penalty.match_gain * (length - band_width - 1) + 2 * penalty.gap_opening_penalty + 2 * (band_width + 1) * penalty.gap_extension_penalty;
+}
+
+
+
+//----------------------------------------------------------------------
+// C_band_aligner::align
+// the band is doubled until no path outside the band can be optimal
+//----------------------------------------------------------------------
+bool C_band_aligner::align(const std::string& string1, const std::string& string2, std::string& alignment1, std::string& alignment2) {
+   length     = string1.length();
+   band_width = std::min(INITIAL_BAND_WIDTH, length);
+
+   while (true) {
+      fill_matrixes(string1, string2);
+
+      // the band covers all the cells
+      if (band_width >= length) {
+         break;
+      }
+
+      if (get_band_score(matrixes) > upper_bound_outside_band()) {
+         break;
+      }
+
+      band_width = std::min(2 * band_width, length);
+   }
+
+   return traceback_band_single_path(matrixes, string1, string2, penalty, alignment1, alignment2);
+}
+
+
+
+//----------------------------------------------------------------------
+// C_simngs_converter::C_simngs_converter
+//----------------------------------------------------------------------
+C_simngs_converter::C_simngs_converter(std::ifstream& in_f_beers, std::ifstream& in_f_simngs, std::ofstream& in_f_location, const char* in_beers_file_name, const char* in_simngs_file_name, const C_alignment_penalty& in_penalty, const std::size_t& in_num_threads) :
+   C_ordered_pipeline<C_batch>(in_num_threads),
+   f_beers(in_f_beers),
+   f_simngs(in_f_simngs),
+   f_location(in_f_location),
+   beers_file_name(in_beers_file_name),
+   simngs_file_name(in_simngs_file_name),
+   penalty(in_penalty),
+   aligners(in_num_threads, C_band_aligner(in_penalty)),
+   num_reads(0),
+   total_num_substitutions(0),
+   total_num_insertions(0),
+   total_num_deletions(0) {
+}
+
+
+
+//----------------------------------------------------------------------
+// C_simngs_converter::read_batch
+// runs in the reader thread
+// beers : >read id / sequence
+// simngs: @read id / sequence / + / quality
+//----------------------------------------------------------------------
+bool C_simngs_converter::read_batch(C_batch& batch) {
+   std::string line_beers;
+   std::string line_simngs;
+
+   batch.read_pairs.reserve(READ_BATCH_SIZE);
+
+   while (batch.read_pairs.size() < READ_BATCH_SIZE) {
+      // beers header
+      if (!std::getline(f_beers, line_beers)) {
+         break;
+      }
+
+      if ((line_beers.length() < 2) || (line_beers[0] != '>')) {
+         std::cout << std::endl << "ERROR(beers): " << line_beers << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+
+      C_read_pair read_pair;
+
+      read_pair.read_id = line_beers.substr(1, line_beers.find_first_of(" \t") - 1);
+      read_pair.strand  = ((num_reads % 2) == 0) ? '+' : '-';
+
+      // beers sequence
+      if (!std::getline(f_beers, read_pair.seq_beers)) {
+         std::cout << std::endl << "ERROR: The number of lines of " << beers_file_name << " is wrong" << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+
+      // simngs header
+      if ((!std::getline(f_simngs, line_simngs)) || (line_simngs.length() < 2) || (line_simngs[0] != '@')) {
+         std::cout << std::endl << "ERROR(simngs): " << line_simngs << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+
+      // simngs sequence, +, and quality
+      if ((!std::getline(f_simngs, read_pair.seq_simngs)) || (!std::getline(f_simngs, line_simngs)) || (!std::getline(f_simngs, line_simngs))) {
+         std::cout << std::endl << "ERROR: The number of lines of " << simngs_file_name << " is wrong" << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+
+      if (read_pair.seq_beers.length() != read_pair.seq_simngs.length()) {
+         std::cout << std::endl << "ERROR: " << read_pair.seq_beers << " vs " << read_pair.seq_simngs << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+
+      batch.read_pairs.push_back(read_pair);
+
+      num_reads++;
+   }
+
+   return (batch.read_pairs.empty() == false);
+}
+
+
+
+//----------------------------------------------------------------------
+// C_simngs_converter::process_batch
+// runs in each worker thread
+//----------------------------------------------------------------------
+void C_simngs_converter::process_batch(C_batch& batch, const std::size_t& thread_id) {
+   batch.num_substitutions = 0;
+   batch.num_insertions    = 0;
+   batch.num_deletions     = 0;
+
+   for (std::size_t it_read = 0; it_read < batch.read_pairs.size(); it_read++) {
+      compare_one_read(aligners[thread_id], batch.read_pairs[it_read], batch);
+   }
+
+   batch.read_pairs.clear();
+   batch.read_pairs.shrink_to_fit();
+}
+
+
+
+//----------------------------------------------------------------------
+// C_simngs_converter::write_batch
+// runs in the calling thread in the input order
+//----------------------------------------------------------------------
+void C_simngs_converter::write_batch(C_batch& batch) {
+   f_location << batch.location_lines;
+
+   total_num_substitutions += batch.num_substitutions;
+   total_num_insertions    += batch.num_insertions;
+   total_num_deletions     += batch.num_deletions;
+}
+
+
+
+//----------------------------------------------------------------------
+// C_simngs_converter::compare_one_read
+// <read name> <ref 1 or 2> <ref name> <strand> <start index> <read length> <substitutions> <insertions> <deletions>
+// ref 1 or 2 : always 1
+// ref name   : "-"
+// start index: 0
+//----------------------------------------------------------------------
+void C_simngs_converter::compare_one_read(C_band_aligner& aligner, const C_read_pair& read_pair, C_batch& batch) {
+   std::string& location_lines = batch.location_lines;
+
+   // Ns in reads
+   if ((read_pair.seq_beers.find_first_of("Nn") != std::string::npos) || (read_pair.seq_simngs.find_first_of("Nn") != std::string::npos)) {
+      location_lines += read_pair.read_id + " N/A\n";
+      return;
+   }
+
+   std::string read_length = std::to_string(read_pair.seq_beers.length());
+
+   // no error is added by simngs
+   if (read_pair.seq_beers == read_pair.seq_simngs) {
+      location_lines += read_pair.read_id + " 1 - " + read_pair.strand + " 0 " + read_length + " - - -\n";
+      return;
+   }
+
+   // errors are added by simngs
+   std::string seq_beers(read_pair.seq_beers);
+   std::string seq_simngs(read_pair.seq_simngs);
+
+   check_sequence(seq_beers);
+   check_sequence(seq_simngs);
+
+   std::string alignment1;
+   std::string alignment2;
+
+   if (aligner.align(seq_beers, seq_simngs, alignment1, alignment2) == false) {
+      location_lines += read_pair.read_id + " N/A\n";
+      return;
+   }
+
+   // index: 1-based, beers-read-based
+   // an insertion is made to the right of the index
+   std::vector<std::pair<std::string, std::string> > substitutions;
+   std::vector<std::pair<std::string, std::string> > insertions;
+   std::vector<std::pair<std::string, std::string> > deletions;
+
+   int index_beers = 0;
+
+   for (std::size_t it_column = 0; it_column < alignment1.length(); it_column++) {
+      // insertion
+      if (alignment1[it_column] == '-') {
+         std::size_t it_end = it_column;
+
+         while ((it_end < alignment1.length()) && (alignment1[it_end] == '-')) {
+            it_end++;
+         }
+
+         insertions.push_back(std::make_pair(std::to_string(index_beers), alignment2.substr(it_column, it_end - it_column)));
+
+         batch.num_insertions += it_end - it_column;
+
+         it_column = it_end - 1;
+         continue;
+      }
+
+      index_beers++;
+
+      // deletion
+      if (alignment2[it_column] == '-') {
+         deletions.push_back(std::make_pair(std::to_string(index_beers), std::string(1, alignment1[it_column])));
+
+         batch.num_deletions++;
+      }
+      // substitution
+      else if (alignment1[it_column] != alignment2[it_column]) {
+         substitutions.push_back(std::make_pair(std::to_string(index_beers), std::string(1, alignment1[it_column]) + "->" + alignment2[it_column]));
+
+         batch.num_substitutions++;
+      }
+   }
+
+   location_lines += read_pair.read_id + " 1 - " + read_pair.strand + " 0 " + read_length;
+
+   write_errors(substitutions, location_lines);
+   write_errors(insertions, location_lines);
+   write_errors(deletions, location_lines);
+
+   location_lines += "\n";
+}
@@ -4,12 +4,16 @@
 //
 // c libraries
 //
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
+#include <stdint.h>
 
 //
 // c++ libraries
 //
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <regex>
@@ -17,25 +21,64 @@
 #include <unordered_map>
 #include <vector>
 
-// DEBUG
+//
+// system libraries
+//
 #include <unistd.h>
 #include <sys/resource.h>
 
+//
+// declarations shared with lib/evaluate.i
+//
+#include "evaluate.h"
+
+//
+// alignment matrixes shared with convert-simngs-to-location.rna
+//
+#include "band-alignment.h"
+
 
 
 //----------------------------------------------------------------------
 // definitins
 //----------------------------------------------------------------------
-#define SMALL_NUMBER -1000000
-#define MIN_OVERLAP  30
+// wavefront alignment
+// reads whose estimated number of edits is larger than (read length * WAVEFRONT_MAX_ERROR_RATE)
+// are aligned using the full matrixes
+#define WAVEFRONT_MIN_EDITS      8
+#define WAVEFRONT_MAX_ERROR_RATE 0.1
+
+// metrics
+// stages of the library whose wall and cpu times are measured
+#define METRICS_DP_FILL        0
+#define METRICS_TRACEBACK      1
+#define METRICS_CLASSIFICATION 2
+#define METRICS_NUM_STAGES     3
+
+// error index records of -detail
+// <chromosome index> <1-based position in ref> <org> <err> <corrected? Y or N> <start index> <end index>
+// the integers are 4-byte big-endian so that records sort in the byte order
+// evaluate.dna appends the number of the read to each record
+#define ERROR_INDEX_RECORD_SIZE 19
+
+// bit-parallel alignment
+// align_bit_parallel keeps the delta vectors of all the columns if they fit in this many bytes
+#define BIT_PARALLEL_MAX_VECTOR_BYTES 268435456.0
 
 
 
 //----------------------------------------------------------------------
 // variables
 //----------------------------------------------------------------------
+// the alignment matrixes only store the cells whose diagonal (x - y) is in
+// [matrix_band_low - 1, matrix_band_high + 1]
+// cell (x, y) is at (matrix_width * y + x + matrix_offset)
+// matrix_width is the distance between two rows, not the number of columns in the banded layout
 int matrix_width;
 int matrix_height;
+int matrix_offset;
+int matrix_band_low;
+int matrix_band_high;
 int match_gain;
 int mismatch_penalty;
 int gap_opening_penalty;
@@ -82,10 +125,13 @@ int num_not_evaluated_insertion;
 int num_not_evaluated_deletion;
 int num_total_bases_percent_similarity;
 int num_matched_bases_percent_similarity;
+int num_bit_parallel_dead_ends;
 int ref_seq_index;
 
 unsigned int max_candidates;
 
+double bit_parallel_max_vector_bytes = BIT_PARALLEL_MAX_VECTOR_BYTES;
+
 std::string string1;
 std::string string2;
 std::string outer_5_end;
@@ -93,6 +139,7 @@ std::string outer_3_end;
 std::string read_name;
 std::string alignment_best;
 std::string error_index_best;
+std::string position_deltas_best;
 std::string substitutions;
 std::string insertions;
 std::string deletions;
@@ -110,6 +157,11 @@ std::vector<int> corrected_position_vector_local_best_tmp;
 std::vector<std::string> alignment1_vector;
 std::vector<std::string> alignment2_vector;
 
+// substitutions decoded by decode_substitutions
+std::vector<int> substitution_index_vector;
+std::string      substitution_org_bases;
+std::string      substitution_err_bases;
+
 std::unordered_map<int, char>        substitution_org_map;
 std::unordered_map<int, char>        substitution_err_map;
 std::unordered_map<int, std::string> insertion_map;
@@ -118,14 +170,79 @@ std::unordered_map<int, char>        deletion_map;
 bool no_end_gap_penalty;
 bool is_trimmed;
 bool is_detail;
+bool is_cache;
 bool too_many_candidates;
+bool use_wavefront;
+
+// metrics
+// they are only accumulated here and read by the driver at the end
+const char* metrics_stage_names[METRICS_NUM_STAGES] = {"dp_fill", "traceback", "classification"};
+
+double metrics_wall_time[METRICS_NUM_STAGES];
+double metrics_cpu_time[METRICS_NUM_STAGES];
+double metrics_num_calls[METRICS_NUM_STAGES];
+double metrics_num_dp_cells;
+double metrics_num_too_many_candidates;
+
+// <number of candidate alignments> => <number of reads>
+std::vector<double> metrics_candidate_histogram;
+
+
+
+//----------------------------------------------------------------------
+// classes
+//----------------------------------------------------------------------
+//
+// C_metrics_timer
+// adds the wall and cpu times between its construction and destruction to a stage
+//
+class C_metrics_timer {
+   private:
+      int  stage;
+      bool stopped;
+
+      struct timespec wall_begin;
+      struct timespec cpu_begin;
+
+      static double elapsed(const struct timespec& begin, const struct timespec& end) {
+         return (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) * 1.0e-9;
+      }
+
+   public:
+      C_metrics_timer(int in_stage) : stage(in_stage), stopped(false) {
+         clock_gettime(CLOCK_MONOTONIC,          &wall_begin);
+         clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_begin);
+      }
+
+      ~C_metrics_timer() {
+         stop();
+      }
+
+      // the stage can be closed before the end of the scope
+      void stop() {
+         if (stopped == true) {
+            return;
+         }
+
+         stopped = true;
+
+         struct timespec wall_end;
+         struct timespec cpu_end;
+
+         clock_gettime(CLOCK_MONOTONIC,          &wall_end);
+         clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_end);
+
+         metrics_wall_time[stage] += elapsed(wall_begin, wall_end);
+         metrics_cpu_time[stage]  += elapsed(cpu_begin,  cpu_end);
+         metrics_num_calls[stage]++;
+      }
+};
 
 
 
 //----------------------------------------------------------------------
 // functions
 //----------------------------------------------------------------------
-// DEBUG
 //
 // get_current_rss
 //
@@ -147,20 +264,195 @@ std::size_t get_current_rss() {
 }
 
 //
-// max3
+// get_peak_rss
+// peak resident set size of this process in bytes
 //
-inline int max3(int a, int b, int c) {
-   int result(a);
+double get_peak_rss() {
+   struct rusage usage;
 
-   if (b > result) {
-      result = b;
+   if (getrusage(RUSAGE_SELF, &usage) != 0) {
+      return 0.0;
    }
 
-   if (c > result) {
-      result = c;
+   // kilobytes in linux
+   return usage.ru_maxrss * 1024.0;
+}
+
+//
+// get_bytes_read
+// bytes this process has read so far including the decompressed streams
+// 0 if /proc/self/io is not available
+//
+double get_bytes_read() {
+   FILE* fp = NULL;
+
+   if ((fp = fopen("/proc/self/io", "r")) == NULL) {
+      return 0.0;
    }
 
-   return result;
+   unsigned long long rchar = 0;
+
+   if (fscanf(fp, "rchar: %llu", &rchar) != 1) {
+      rchar = 0;
+   }
+
+   fclose(fp);
+
+   return (double)rchar;
+}
+
+//
+// estimate_dp_memory
+// bytes allocated to align strings of the given lengths using fill_matrixes and find_best_alignment
+// three int matrixes, the wavefronts used to find the band, the traceback strings of one alignment,
+// and the candidate alignments
+// the full matrixes are counted because fill_matrixes falls back to them when the wavefront band fails
+// the scores, use_wavefront, and max_candidates should be set before this function is called
+//
+double estimate_dp_memory(int in_string1_length, int in_string2_length) {
+   double bytes(3.0 * sizeof(int) * (in_string1_length + 1.0) * (in_string2_length + 1.0));
+
+   if (use_wavefront) {
+      int penalty_mismatch(2 * (match_gain - mismatch_penalty));
+      int penalty_gap(-2 * gap_opening_penalty + match_gain - 2 * gap_extension_penalty);
+      int num_wavefronts(std::max(penalty_mismatch, penalty_gap) + 1);
+
+      bytes += 3.0 * sizeof(int) * num_wavefronts * (in_string1_length + in_string2_length + 1.0);
+   }
+
+   bytes += 2.0 * (in_string1_length + in_string2_length);
+
+   // traceback keeps up to max_candidates + 1 pairs of alignments
+   // and each alignment is at most as long as the two strings together
+   bytes += 2.0 * (max_candidates + 1.0) * (in_string1_length + in_string2_length + sizeof(std::string));
+
+   return bytes;
+}
+
+//
+// get_bit_parallel_segment_length
+// number of columns whose delta vectors align_bit_parallel keeps at a time
+// all the columns if their delta vectors fit in bit_parallel_max_vector_bytes
+// otherwise about the square root of the number of columns
+//
+int get_bit_parallel_segment_length(int in_string1_length, int in_string2_length) {
+   double num_blocks((in_string2_length + 63) / 64);
+
+   if (4.0 * sizeof(uint64_t) * (in_string1_length + 1.0) * num_blocks <= bit_parallel_max_vector_bytes) {
+      return std::max(in_string1_length, 1);
+   }
+
+   int segment_length(1);
+
+   while ((double)segment_length * segment_length < in_string1_length + 1.0) {
+      segment_length++;
+   }
+
+   return segment_length;
+}
+
+//
+// estimate_bit_parallel_memory
+// bytes allocated by align_bit_parallel
+// match vectors, four delta vectors of every column in a segment, the checkpoints of the segments,
+// the last row, and the alignment strings
+//
+double estimate_bit_parallel_memory(int in_string1_length, int in_string2_length) {
+   double num_blocks((in_string2_length + 63) / 64);
+   double segment_length(get_bit_parallel_segment_length(in_string1_length, in_string2_length));
+   double num_checkpoints(0.0);
+
+   if (segment_length < in_string1_length) {
+      num_checkpoints = (double)((in_string1_length + (int)segment_length - 1) / (int)segment_length);
+   }
+
+   return sizeof(uint64_t) * (256.0 * num_blocks + 4.0 * (segment_length + 1.0) * num_blocks + 2.0 * num_checkpoints * num_blocks) +
+          sizeof(int) * (in_string1_length + 1.0) +
+          2.0 * (in_string1_length + in_string2_length);
+}
+
+//
+// metrics accessors
+// used by the driver to export the metrics of the library
+//
+int metrics_num_stages() {
+   return METRICS_NUM_STAGES;
+}
+
+std::string metrics_stage_name(int stage) {
+   return metrics_stage_names[stage];
+}
+
+double metrics_stage_wall_time(int stage) {
+   return metrics_wall_time[stage];
+}
+
+double metrics_stage_cpu_time(int stage) {
+   return metrics_cpu_time[stage];
+}
+
+double metrics_stage_calls(int stage) {
+   return metrics_num_calls[stage];
+}
+
+double metrics_dp_cells() {
+   return metrics_num_dp_cells;
+}
+
+double metrics_too_many_candidates() {
+   return metrics_num_too_many_candidates;
+}
+
+int metrics_candidate_histogram_size() {
+   return metrics_candidate_histogram.size();
+}
+
+double metrics_candidate_histogram_count(int num_candidates) {
+   return metrics_candidate_histogram[num_candidates];
+}
+
+//
+// get_matrix_index
+// index of cell (x, y) in the alignment matrixes
+//
+inline int get_matrix_index(int index_x, int index_y) {
+   return matrix_width * index_y + index_x + matrix_offset;
+}
+
+//
+// get_alignment_penalty
+//
+inline C_alignment_penalty get_alignment_penalty() {
+   C_alignment_penalty penalty;
+
+   penalty.match_gain            = match_gain;
+   penalty.mismatch_penalty      = mismatch_penalty;
+   penalty.gap_opening_penalty   = gap_opening_penalty;
+   penalty.gap_extension_penalty = gap_extension_penalty;
+   penalty.no_end_gap_penalty    = no_end_gap_penalty;
+
+   return penalty;
+}
+
+//
+// get_band_matrixes
+// the current alignment matrixes in the layout of band-alignment.h
+//
+inline C_band_matrixes get_band_matrixes() {
+   C_band_matrixes matrixes;
+
+   matrixes.match_matrix   = match_matrix;
+   matrixes.gap_1_matrix   = gap_1_matrix;
+   matrixes.gap_2_matrix   = gap_2_matrix;
+   matrixes.string1_length = string1_length;
+   matrixes.string2_length = string2_length;
+   matrixes.band_low       = matrix_band_low;
+   matrixes.band_high      = matrix_band_high;
+   matrixes.width          = matrix_width;
+   matrixes.offset         = matrix_offset;
+   matrixes.size           = matrix_size;
+
+   return matrixes;
 }
 
 //
@@ -184,6 +476,37 @@ inline int max4(int a, int b, int c, int d) {
    return result;
 }
 
+//
+// append_error_index_record
+// appends a fixed-size binary record of the current reference window to an error index
+// evaluate.dna adds the records to its sorted runs without parsing them
+//
+inline void append_error_index_record(std::string& error_index, int current_index, char org_base, char err_base, char corrected) {
+   char record[ERROR_INDEX_RECORD_SIZE];
+
+   record[0]  = (ref_seq_index >> 24) & 0xff;
+   record[1]  = (ref_seq_index >> 16) & 0xff;
+   record[2]  = (ref_seq_index >> 8)  & 0xff;
+   record[3]  =  ref_seq_index        & 0xff;
+   record[4]  = (current_index >> 24) & 0xff;
+   record[5]  = (current_index >> 16) & 0xff;
+   record[6]  = (current_index >> 8)  & 0xff;
+   record[7]  =  current_index        & 0xff;
+   record[8]  = org_base;
+   record[9]  = err_base;
+   record[10] = corrected;
+   record[11] = (start_index >> 24) & 0xff;
+   record[12] = (start_index >> 16) & 0xff;
+   record[13] = (start_index >> 8)  & 0xff;
+   record[14] =  start_index        & 0xff;
+   record[15] = (end_index >> 24)   & 0xff;
+   record[16] = (end_index >> 16)   & 0xff;
+   record[17] = (end_index >> 8)    & 0xff;
+   record[18] =  end_index          & 0xff;
+
+   error_index.append(record, ERROR_INDEX_RECORD_SIZE);
+}
+
 //
 // complement_base
 //
@@ -222,8 +545,14 @@ void initialize_variables() {
    string1_length           = string1.length();
    string2_length           = string2.length();
    matrix_size              = matrix_width * matrix_height;
+   matrix_offset            = 0;
+   matrix_band_low          = -string2_length;
+   matrix_band_high         = string1_length;
    longest_alignment_length = string1_length + string2_length;
 
+   // counted by align_bit_parallel
+   num_bit_parallel_dead_ends = 0;
+
    alignment1_vector.clear();
    alignment2_vector.clear();
 
@@ -284,220 +613,424 @@ void decode_errors() {
 }
 
 //
-// fill_matrixes
+// fill_matrixes_band
+// the first row and the first column should be initialized before this function
 //
-void fill_matrixes() {
-   // resize matrixes
-   match_matrix = new int[matrix_size];
-   gap_1_matrix = new int[matrix_size];
-   gap_2_matrix = new int[matrix_size];
+void fill_matrixes_band() {
+   metrics_num_dp_cells += fill_band_matrixes(get_band_matrixes(), string1, string2, get_alignment_penalty());
+}
+
+//
+// wavefront_offset
+// offset of a diagonal in a wavefront
+// SMALL_NUMBER if the diagonal is not in the wavefront
+//
+inline int wavefront_offset(const std::vector<int>& wavefront, const std::vector<int>& wavefront_low, const std::vector<int>& wavefront_high, int penalty, int diagonal, int num_wavefronts, int num_diagonals) {
+   int index(penalty % num_wavefronts);
+
+   if ((diagonal < wavefront_low[index]) || (diagonal > wavefront_high[index])) {
+      return SMALL_NUMBER;
+   }
+
+   return wavefront[index * num_diagonals + diagonal + string2_length];
+}
+
+//
+// find_wavefront_band
+//
+// gap-affine wavefront alignment (WFA) of string1 and string2
+// it takes O((string1_length + string2_length) * s) time where s is the optimal penalty below
+//
+// the scores of fill_matrixes are converted to non-negative penalties
+// penalty = match_gain * (string1_length + string2_length) - 2 * score
+// match                        : 0
+// mismatch                     : 2 * (match_gain - mismatch_penalty)
+// gap opening                  : -2 * gap_opening_penalty
+// gap extension (each base)    : match_gain - 2 * gap_extension_penalty
+// end gap in the no end gap mode: match_gain for each base
+//
+// moving to the next diagonal costs at least the smallest gap base penalty
+// so all the optimal alignments are in a band around diagonal 0 and (string1_length - string2_length)
+// whose width is determined by the optimal penalty
+//
+// this function returns false if
+// 1. the penalties are not positive
+// 2. the read is expected to have too many errors (see WAVEFRONT_MAX_ERROR_RATE)
+// 3. the optimal penalty is larger than the one estimated from the known errors
+//
+// offsets in wavefronts are the indexes of string1, and diagonals are (offset - the index of string2)
+//
+bool find_wavefront_band(int& band_low, int& band_high, int& expected_score) {
+   if ((string1_length == 0) || (string2_length == 0)) {
+      return false;
+   }
+
+   int penalty_mismatch(2 * (match_gain - mismatch_penalty));
+   int penalty_gap_opening(-2 * gap_opening_penalty);
+   int penalty_gap_extension(match_gain - 2 * gap_extension_penalty);
+   int penalty_end_gap(match_gain);
+
+   if ((penalty_mismatch <= 0) || (penalty_gap_opening < 0) || (penalty_gap_extension <= 0) || (no_end_gap_penalty && (penalty_end_gap <= 0))) {
+      return false;
+   }
 
    //----------------------------------------------------------------------
-   // initialize matrixes
+   // edit bound
    //----------------------------------------------------------------------
-   //
-   // match
-   //
-   // (0, 0)
-   match_matrix[0] = 0;
+   // the errors in the original read plus some margin for the ones made by correction
+   int length_difference(abs(string1_length - string2_length));
+   int edit_bound(2 * (num_substitutions + num_insertions_unit + num_deletions) + WAVEFRONT_MIN_EDITS);
 
-   // first row
-   for(int it_x = 1; it_x < matrix_width; it_x++) {
-      match_matrix[it_x] = SMALL_NUMBER;
+   if (edit_bound > string2_length * WAVEFRONT_MAX_ERROR_RATE) {
+      return false;
    }
 
-   // first column
-   for(int it_y = 1; it_y < matrix_height; it_y++) {
-      match_matrix[matrix_width * it_y] = SMALL_NUMBER;
-   }
+   int penalty_gap_base(penalty_gap_extension);
 
-   //
-   // gap 1
-   //
-   // first row (including origin)
-   for(int it_x = 0; it_x < matrix_width; it_x++) {
-      gap_1_matrix[it_x] = SMALL_NUMBER;
+   if (no_end_gap_penalty) {
+      penalty_gap_base = std::min(penalty_gap_extension, penalty_end_gap);
    }
 
-   // first column (excluding origin)
-   for(int it_y = 1; it_y < matrix_height; it_y++) {
-      if (no_end_gap_penalty) {
-         gap_1_matrix[matrix_width * it_y] = 0;
+   int max_penalty(edit_bound * std::max(penalty_mismatch, penalty_gap_opening + penalty_gap_extension) +
+                   length_difference * std::max(penalty_gap_extension, penalty_end_gap) + penalty_gap_opening);
+
+   //----------------------------------------------------------------------
+   // wavefronts
+   //----------------------------------------------------------------------
+   // only the last (max penalty of a single step + 1) wavefronts are kept
+   int num_wavefronts(std::max(penalty_mismatch, penalty_gap_opening + penalty_gap_extension) + 1);
+   int num_diagonals(string1_length + string2_length + 1);
+
+   // diagonal k is stored at (k + string2_length)
+   std::vector<int> wavefront_m(num_wavefronts * num_diagonals, SMALL_NUMBER);
+   std::vector<int> wavefront_i(num_wavefronts * num_diagonals, SMALL_NUMBER);
+   std::vector<int> wavefront_d(num_wavefronts * num_diagonals, SMALL_NUMBER);
+
+   // [low, high] diagonals of each wavefront
+   // high < low if the wavefront is empty
+   std::vector<int> wavefront_low(num_wavefronts, 0);
+   std::vector<int> wavefront_high(num_wavefronts, -1);
+
+   int best_penalty(max_penalty + 1);
+
+   for (int it_penalty = 0; (it_penalty <= max_penalty) && (it_penalty < best_penalty); it_penalty++) {
+      int current(it_penalty % num_wavefronts);
+
+      int* current_m = &wavefront_m[current * num_diagonals + string2_length];
+      int* current_i = &wavefront_i[current * num_diagonals + string2_length];
+      int* current_d = &wavefront_d[current * num_diagonals + string2_length];
+
+      // source wavefronts
+      int source_mismatch(it_penalty - penalty_mismatch);
+      int source_opening(it_penalty - penalty_gap_opening - penalty_gap_extension);
+      int source_extension(it_penalty - penalty_gap_extension);
+
+      int low(string1_length + 1);
+      int high(-string2_length - 1);
+
+      if (source_mismatch >= 0) {
+         low  = std::min(low,  wavefront_low[source_mismatch % num_wavefronts]);
+         high = std::max(high, wavefront_high[source_mismatch % num_wavefronts]);
       }
-      else {
-         gap_1_matrix[matrix_width * it_y] = gap_opening_penalty + it_y * gap_extension_penalty;
+
+      if (source_opening >= 0) {
+         low  = std::min(low,  wavefront_low[source_opening % num_wavefronts] - 1);
+         high = std::max(high, wavefront_high[source_opening % num_wavefronts] + 1);
       }
-   }
 
-   //
-   // gap 2
-   //
-   // first row (excluding origin)
-   for(int it_x = 1; it_x < matrix_width; it_x++) {
-      if (no_end_gap_penalty) {
-         gap_2_matrix[it_x] = 0;
+      if (source_extension >= 0) {
+         low  = std::min(low,  wavefront_low[source_extension % num_wavefronts] - 1);
+         high = std::max(high, wavefront_high[source_extension % num_wavefronts] + 1);
       }
-      else {
-         gap_2_matrix[it_x] = gap_opening_penalty + it_x * gap_extension_penalty;
+
+      // the origin and the free end gaps at the beginning
+      int end_gap_length(-1);
+
+      if (it_penalty == 0) {
+         low  = std::min(low, 0);
+         high = std::max(high, 0);
       }
-   }
+      else if (no_end_gap_penalty && ((it_penalty % penalty_end_gap) == 0)) {
+         end_gap_length = it_penalty / penalty_end_gap;
 
-   // first column (including origin)
-   for(int it_y = 0; it_y < matrix_height; it_y++) {
-      gap_2_matrix[matrix_width * it_y] = SMALL_NUMBER;
-   }
+         low  = std::min(low,  -std::min(end_gap_length, string2_length));
+         high = std::max(high,  std::min(end_gap_length, string1_length));
+      }
 
-   //----------------------------------------------------------------------
-   // fill remainings
-   //----------------------------------------------------------------------
-   // start from (1, 1)
-   int matrix_index(matrix_width + 1);
-   int index_up(1);
-   int index_left(matrix_width);
-   int index_up_left(0);
+      low  = std::max(low,  -string2_length);
+      high = std::min(high,  string1_length);
 
-   int match_penalty_tmp;
+      wavefront_low[current]  = low;
+      wavefront_high[current] = high;
 
-   for (int index_y = 0; index_y < string2_length; index_y++) {
-      for (int index_x = 0; index_x < string1_length; index_x++) {
+      for (int it_diagonal = low; it_diagonal <= high; it_diagonal++) {
          //
-         // match
+         // gap in string1 (y + 1)
          //
-         if (string1[index_x] == string2[index_y]) {
-            match_penalty_tmp = match_gain;
+         int offset_i(SMALL_NUMBER);
+
+         if (source_opening >= 0) {
+            offset_i = std::max(offset_i, wavefront_offset(wavefront_m, wavefront_low, wavefront_high, source_opening, it_diagonal + 1, num_wavefronts, num_diagonals));
+            offset_i = std::max(offset_i, wavefront_offset(wavefront_d, wavefront_low, wavefront_high, source_opening, it_diagonal + 1, num_wavefronts, num_diagonals));
          }
-         else {
-            match_penalty_tmp = mismatch_penalty;
+
+         if (source_extension >= 0) {
+            offset_i = std::max(offset_i, wavefront_offset(wavefront_i, wavefront_low, wavefront_high, source_extension, it_diagonal + 1, num_wavefronts, num_diagonals));
          }
 
-         match_matrix[matrix_index] = max3(
-                                            match_matrix[index_up_left] + match_penalty_tmp,
-                                            gap_1_matrix[index_up_left] + match_penalty_tmp,
-                                            gap_2_matrix[index_up_left] + match_penalty_tmp
-                                           );
+         if (offset_i - it_diagonal > string2_length) {
+            offset_i = SMALL_NUMBER;
+         }
 
          //
-         // gap 1
+         // gap in string2 (x + 1)
          //
-         // the last column in the no end gap mode
-         if (no_end_gap_penalty && (index_x == (string1_length - 1))) {
-            gap_1_matrix[matrix_index] = max3(
-                                               match_matrix[index_up],
-                                               gap_1_matrix[index_up],
-                                               gap_2_matrix[index_up]
-                                              );
+         int offset_d(SMALL_NUMBER);
+
+         if (source_opening >= 0) {
+            offset_d = std::max(offset_d, wavefront_offset(wavefront_m, wavefront_low, wavefront_high, source_opening, it_diagonal - 1, num_wavefronts, num_diagonals));
+            offset_d = std::max(offset_d, wavefront_offset(wavefront_i, wavefront_low, wavefront_high, source_opening, it_diagonal - 1, num_wavefronts, num_diagonals));
          }
-         // other columns
-         else {
-            gap_1_matrix[matrix_index] = max3(
-                                               match_matrix[index_up] + gap_opening_penalty + gap_extension_penalty,
-                                               gap_1_matrix[index_up] + gap_extension_penalty,
-                                               gap_2_matrix[index_up] + gap_opening_penalty + gap_extension_penalty
-                                              );
+
+         if (source_extension >= 0) {
+            offset_d = std::max(offset_d, wavefront_offset(wavefront_d, wavefront_low, wavefront_high, source_extension, it_diagonal - 1, num_wavefronts, num_diagonals));
+         }
+
+         if (offset_d >= 0) {
+            offset_d++;
+         }
+
+         if (offset_d > string1_length) {
+            offset_d = SMALL_NUMBER;
          }
 
          //
-         // gap 2
+         // mismatch (x + 1, y + 1)
          //
-         // the last row in the no end gap mode
-         if (no_end_gap_penalty && (index_y == (string2_length - 1))) {
-            gap_2_matrix[matrix_index] = max3(
-                                               match_matrix[index_left],
-                                               gap_1_matrix[index_left],
-                                               gap_2_matrix[index_left]
-                                              );
-         }
-         // normal situation
-         else {
-            gap_2_matrix[matrix_index] = max3(
-                                               match_matrix[index_left] + gap_opening_penalty + gap_extension_penalty,
-                                               gap_1_matrix[index_left] + gap_opening_penalty + gap_extension_penalty,
-                                               gap_2_matrix[index_left] + gap_extension_penalty
-                                              );
+         int offset_m(SMALL_NUMBER);
+
+         if (source_mismatch >= 0) {
+            offset_m = wavefront_offset(wavefront_m, wavefront_low, wavefront_high, source_mismatch, it_diagonal, num_wavefronts, num_diagonals);
+
+            if (offset_m >= 0) {
+               offset_m++;
+
+               if ((offset_m > string1_length) || (offset_m - it_diagonal > string2_length)) {
+                  offset_m = SMALL_NUMBER;
+               }
+            }
          }
 
-         // skep the first column
-         matrix_index++;
-         index_up++;
-         index_left++;
-         index_up_left++;
-      }
+         // the origin
+         if ((it_penalty == 0) && (it_diagonal == 0)) {
+            offset_m = 0;
+         }
 
-      matrix_index++;
-      index_up++;
-      index_left++;
-      index_up_left++;
-   }
-}
+         // free end gaps at the beginning
+         // (0, end_gap_length) in gap 1 and (end_gap_length, 0) in gap 2
+         if (end_gap_length > 0) {
+            if ((it_diagonal == -end_gap_length) && (end_gap_length <= string2_length)) {
+               offset_i = std::max(offset_i, 0);
+            }
 
-//
-// print_matrixes
-//
-void print_matrixes() {
-   //
-   // match
-   //
-   std::cout << "\n";
-   std::cout << "Match:\n";
+            if ((it_diagonal == end_gap_length) && (end_gap_length <= string1_length)) {
+               offset_d = std::max(offset_d, end_gap_length);
+            }
+         }
 
-   for (int it_matrix = 0; it_matrix < matrix_size; it_matrix++) {
-      std::cout << " " << std::setw(12) << match_matrix[it_matrix];
+         offset_m = max3(offset_m, offset_i, offset_d);
 
-      if ((it_matrix % matrix_width) == (matrix_width - 1)) {
-         std::cout << "\n";
-      }
-   }
+         // extend matches
+         if (offset_m >= 0) {
+            int index_x(offset_m);
+            int index_y(offset_m - it_diagonal);
 
-   std::cout << "\n";
+            while ((index_x < string1_length) && (index_y < string2_length) && (string1[index_x] == string2[index_y])) {
+               index_x++;
+               index_y++;
+            }
 
-   //
-   // gap 1
-   //
-   std::cout << "Gap 1:\n";
+            offset_m = index_x;
 
-   for (int it_matrix = 0; it_matrix < matrix_size; it_matrix++) {
-      std::cout << " " << std::setw(12) << gap_1_matrix[it_matrix];
+            //
+            // reach the end
+            //
+            // the bottom-right cell
+            if ((index_x == string1_length) && (index_y == string2_length)) {
+               best_penalty = std::min(best_penalty, it_penalty);
+            }
+            // the last column or the last row in the no end gap mode
+            else if (no_end_gap_penalty) {
+               if (index_x == string1_length) {
+                  best_penalty = std::min(best_penalty, it_penalty + penalty_end_gap * (string2_length - index_y));
+               }
+               else if (index_y == string2_length) {
+                  best_penalty = std::min(best_penalty, it_penalty + penalty_end_gap * (string1_length - index_x));
+               }
+            }
+         }
 
-      if ((it_matrix % matrix_width) == (matrix_width - 1)) {
-         std::cout << "\n";
+         current_m[it_diagonal] = offset_m;
+         current_i[it_diagonal] = offset_i;
+         current_d[it_diagonal] = offset_d;
       }
-   }
 
-   std::cout << "\n";
+      // remove the empty diagonals at both ends
+      // offset_m is not smaller than offset_i and offset_d
+      while ((low <= high) && (current_m[low] < 0)) {
+         low++;
+      }
 
-   //
-   // gap 2
-   //
-   std::cout << "Gap 2:\n";
+      while ((low <= high) && (current_m[high] < 0)) {
+         high--;
+      }
 
-   for (int it_matrix = 0; it_matrix < matrix_size; it_matrix++) {
-      std::cout << " " << std::setw(12) << gap_2_matrix[it_matrix];
+      wavefront_low[current]  = low;
+      wavefront_high[current] = high;
+   }
 
-      if ((it_matrix % matrix_width) == (matrix_width - 1)) {
-         std::cout << "\n";
-      }
+   if (best_penalty > max_penalty) {
+      return false;
    }
 
-   std::cout << "\n";
+   //----------------------------------------------------------------------
+   // band
+   //----------------------------------------------------------------------
+   int diagonal_end(string1_length - string2_length);
+   int band_margin((best_penalty / penalty_gap_base - length_difference) / 2);
+
+   band_low       = std::min(0, diagonal_end) - band_margin;
+   band_high      = std::max(0, diagonal_end) + band_margin;
+   expected_score = (match_gain * (string1_length + string2_length) - best_penalty) / 2;
+
+   return true;
 }
 
 //
-// traceback
+// allocate_matrixes
 //
-inline void traceback(std::string alignment1, std::string alignment2, int index_x, int index_y, char current_matrix, int alignment_index, int matrix_index, int current_score) {
-   // first row or first column
-   if ((index_x == 0) || (index_y == 0)) {
-      // gap in string1
-      while(index_y > 0) {
-         alignment1[alignment_index] = '-';
-         alignment2[alignment_index] = string2[index_y - 1];
+// allocate the alignment matrixes for the diagonal band [band_low, band_high]
+// and initialize their first row and first column
+// see C_band_matrixes in band-alignment.h for the layout
+//
+void allocate_matrixes(int band_low, int band_high) {
+   C_band_matrixes matrixes;
 
-         alignment_index--;
-         index_y--;
-      }
+   set_band_layout(matrixes, string1_length, string2_length, band_low, band_high);
 
-      // gap in string2
-      while(index_x > 0) {
+   matrix_width     = matrixes.width;
+   matrix_offset    = matrixes.offset;
+   matrix_size      = matrixes.size;
+   matrix_band_low  = matrixes.band_low;
+   matrix_band_high = matrixes.band_high;
+
+   // resize matrixes
+   match_matrix = new int[matrix_size];
+   gap_1_matrix = new int[matrix_size];
+   gap_2_matrix = new int[matrix_size];
+
+   initialize_band_matrixes(get_band_matrixes(), get_alignment_penalty());
+}
+
+//
+// fill_matrixes
+//
+void fill_matrixes() {
+   C_metrics_timer timer(METRICS_DP_FILL);
+
+   // only the diagonal band that contains all the optimal alignments is allocated and filled
+   // if the wavefront alignment finds the optimal score within the edit bound
+   int band_low;
+   int band_high;
+   int expected_score;
+
+   if (use_wavefront && find_wavefront_band(band_low, band_high, expected_score)) {
+      allocate_matrixes(band_low, band_high);
+      fill_matrixes_band();
+
+      if (get_band_score(get_band_matrixes()) == expected_score) {
+         return;
+      }
+
+      delete[] match_matrix;
+      delete[] gap_1_matrix;
+      delete[] gap_2_matrix;
+   }
+
+   // all the cells
+   allocate_matrixes(-string2_length, string1_length);
+   fill_matrixes_band();
+}
+
+//
+// print_matrix
+// cells that are not stored in the band are printed as dots
+//
+void print_matrix(const int* matrix) {
+   for (int it_y = 0; it_y <= string2_length; it_y++) {
+      for (int it_x = 0; it_x <= string1_length; it_x++) {
+         if ((it_x - it_y < matrix_band_low - 1) || (it_x - it_y > matrix_band_high + 1)) {
+            std::cout << " " << std::setw(12) << ".";
+         }
+         else {
+            std::cout << " " << std::setw(12) << matrix[get_matrix_index(it_x, it_y)];
+         }
+      }
+
+      std::cout << "\n";
+   }
+}
+
+//
+// print_matrixes
+//
+void print_matrixes() {
+   //
+   // match
+   //
+   std::cout << "\n";
+   std::cout << "Match:\n";
+
+   print_matrix(match_matrix);
+
+   std::cout << "\n";
+
+   //
+   // gap 1
+   //
+   std::cout << "Gap 1:\n";
+
+   print_matrix(gap_1_matrix);
+
+   std::cout << "\n";
+
+   //
+   // gap 2
+   //
+   std::cout << "Gap 2:\n";
+
+   print_matrix(gap_2_matrix);
+
+   std::cout << "\n";
+}
+
+//
+// traceback
+//
+inline void traceback(std::string alignment1, std::string alignment2, int index_x, int index_y, char current_matrix, int alignment_index, int matrix_index, int current_score) {
+   // first row or first column
+   if ((index_x == 0) || (index_y == 0)) {
+      // gap in string1
+      while(index_y > 0) {
+         alignment1[alignment_index] = '-';
+         alignment2[alignment_index] = string2[index_y - 1];
+
+         alignment_index--;
+         index_y--;
+      }
+
+      // gap in string2
+      while(index_x > 0) {
          alignment1[alignment_index] = string1[index_x - 1];
          alignment2[alignment_index] = '-';
 
@@ -663,6 +1196,22 @@ inline void traceback(std::string alignment1, std::string alignment2, int index_
    }
 }
 
+//
+// traceback_single_path
+//
+// follows a single optimal path from the bottom-right cell to the first row or column
+// without recursion, in O(string1_length + string2_length) time
+// this is the first candidate traceback() would find (see traceback_band_single_path in band-alignment.h)
+//
+// return value
+// true : alignment1/2 are filled
+// false: the overlap between string1 and string2 is shorter than MIN_OVERLAP
+//        or no consistent path is found; alignment1/2 are empty
+//
+inline bool traceback_single_path(std::string& alignment1, std::string& alignment2) {
+   return traceback_band_single_path(get_band_matrixes(), string1, string2, get_alignment_penalty(), alignment1, alignment2);
+}
+
 //
 // evaluate_each_alignment
 //
@@ -1072,16 +1621,8 @@ inline void evaluate_each_alignment(std::string alignment1, std::string alignmen
                   exit(EXIT_FAILURE);
                }
 
-               error_index_tmp += 
-                                 (std::to_string(ref_seq_index) + " " +
-                                  std::to_string(current_index) + " " +
-                                  org_base                      + " " +
-                                  err_base                      + " " +
-                                  "Y CASE05"                    + " " +
-                                  read_name                     + " " +
-                                  std::to_string(start_index)   + " " +
-                                  std::to_string(end_index)     + "\n"
-                                 );
+               // CASE05
+               append_error_index_record(error_index_tmp, current_index, org_base, err_base, 'Y');
 
             }
          }
@@ -1123,16 +1664,8 @@ inline void evaluate_each_alignment(std::string alignment1, std::string alignmen
                   exit(EXIT_FAILURE);
                }
 
-               error_index_tmp += 
-                                 (std::to_string(ref_seq_index) + " " +
-                                  std::to_string(current_index) + " " +
-                                  org_base                      + " " +
-                                  err_base                      + " " +
-                                  "Y CASE06"                    + " " +
-                                  read_name                     + " " +
-                                  std::to_string(start_index)   + " " +
-                                  std::to_string(end_index)     + "\n"
-                                 );
+               // CASE06
+               append_error_index_record(error_index_tmp, current_index, org_base, err_base, 'Y');
             }
          }
       }
@@ -1203,16 +1736,8 @@ inline void evaluate_each_alignment(std::string alignment1, std::string alignmen
                   exit(EXIT_FAILURE);
                }
 
-               error_index_tmp += 
-                                 (std::to_string(ref_seq_index) + " " +
-                                  std::to_string(current_index) + " " +
-                                  org_base                      + " " +
-                                  err_base                      + " " +
-                                  "Y CASE07"                    + " " +
-                                  read_name                     + " " +
-                                  std::to_string(start_index)   + " " +
-                                  std::to_string(end_index)     + "\n" 
-                                 );
+               // CASE07
+               append_error_index_record(error_index_tmp, current_index, org_base, err_base, 'Y');
             }
          }
       }
@@ -1328,16 +1853,8 @@ inline void evaluate_each_alignment(std::string alignment1, std::string alignmen
                            exit(EXIT_FAILURE);
                         }
 
-                        error_index_tmp += 
-                                          (std::to_string(ref_seq_index) + " " +
-                                           std::to_string(current_index) + " " +
-                                           org_base                      + " " +
-                                           err_base                      + " " +
-                                           "Y CASE08"                    + " " +
-                                           read_name                     + " " +
-                                           std::to_string(start_index)   + " " +
-                                           std::to_string(end_index)     + "\n" 
-                                          );
+                        // CASE08
+                        append_error_index_record(error_index_tmp, current_index, org_base, err_base, 'Y');
                      }
                   }
                }
@@ -1461,16 +1978,8 @@ inline void evaluate_each_alignment(std::string alignment1, std::string alignmen
                            exit(EXIT_FAILURE);
                         }
 
-                        error_index_tmp += 
-                                          (std::to_string(ref_seq_index) + " " +
-                                           std::to_string(current_index) + " " +
-                                           org_base                      + " " +
-                                           err_base                      + " " +
-                                           "N CASE09"                    + " " +
-                                           read_name                     + " " +
-                                           std::to_string(start_index)   + " " +
-                                           std::to_string(end_index)     + "\n" 
-                                          );
+                        // CASE09
+                        append_error_index_record(error_index_tmp, current_index, org_base, err_base, 'N');
                      }
                   }
 
@@ -1519,16 +2028,8 @@ inline void evaluate_each_alignment(std::string alignment1, std::string alignmen
                               exit(EXIT_FAILURE);
                            }
 
-                           error_index_tmp += 
-                                             (std::to_string(ref_seq_index) + " " +
-                                              std::to_string(current_index) + " " +
-                                              org_base                      + " " +
-                                              err_base                      + " " +
-                                              "Y CASE10"                    + " " +
-                                              read_name                     + " " +
-                                              std::to_string(start_index)   + " " +
-                                              std::to_string(end_index)     + "\n" 
-                                             );
+                           // CASE10
+                           append_error_index_record(error_index_tmp, current_index, org_base, err_base, 'Y');
                         }
                      }
                      // wrong  modification
@@ -1571,16 +2072,8 @@ inline void evaluate_each_alignment(std::string alignment1, std::string alignmen
                               exit(EXIT_FAILURE);
                            }
 
-                           error_index_tmp += 
-                                             (std::to_string(ref_seq_index) + " " +
-                                              std::to_string(current_index) + " " +
-                                              org_base                      + " " +
-                                              err_base                      + " " +
-                                              "N CASE11"                    + " " +
-                                              read_name                     + " " +
-                                              std::to_string(start_index)   + " " +
-                                              std::to_string(end_index)     + "\n" 
-                                             );
+                           // CASE11
+                           append_error_index_record(error_index_tmp, current_index, org_base, err_base, 'N');
                         }
                      }
                   }
@@ -1677,16 +2170,8 @@ inline void evaluate_each_alignment(std::string alignment1, std::string alignmen
                   exit(EXIT_FAILURE);
                }
 
-               error_index_tmp += 
-                                 (std::to_string(ref_seq_index) + " " +
-                                  std::to_string(current_index) + " " +
-                                  org_base                      + " " +
-                                  err_base                      + " " +
-                                  "Y CASE12"                    + " " +
-                                  read_name                     + " " +
-                                  std::to_string(start_index)   + " " +
-                                  std::to_string(end_index)     + "\n" 
-                                 );
+               // CASE12
+               append_error_index_record(error_index_tmp, current_index, org_base, err_base, 'Y');
             }
          }
       }
@@ -1771,16 +2256,8 @@ inline void evaluate_each_alignment(std::string alignment1, std::string alignmen
                            exit(EXIT_FAILURE);
                         }
 
-                        error_index_tmp += 
-                                          (std::to_string(ref_seq_index) + " " +
-                                           std::to_string(current_index) + " " +
-                                           org_base                      + " " +
-                                           err_base                      + " " +
-                                           "Y CASE13"                    + " " +
-                                           read_name                     + " " +
-                                           std::to_string(start_index)   + " " +
-                                           std::to_string(end_index)     + "\n" 
-                                          );
+                        // CASE13
+                        append_error_index_record(error_index_tmp, current_index, org_base, err_base, 'Y');
                      }
                   }
                }
@@ -1904,16 +2381,8 @@ inline void evaluate_each_alignment(std::string alignment1, std::string alignmen
                            exit(EXIT_FAILURE);
                         }
 
-                        error_index_tmp += 
-                                          (std::to_string(ref_seq_index) + " " +
-                                           std::to_string(current_index) + " " +
-                                           org_base                      + " " +
-                                           err_base                      + " " +
-                                           "N CASE14"                    + " " +
-                                           read_name                     + " " +
-                                           std::to_string(start_index)   + " " +
-                                           std::to_string(end_index)     + "\n" 
-                                          );
+                        // CASE14
+                        append_error_index_record(error_index_tmp, current_index, org_base, err_base, 'N');
                      }
                   }
 
@@ -1962,16 +2431,8 @@ inline void evaluate_each_alignment(std::string alignment1, std::string alignmen
                               exit(EXIT_FAILURE);
                            }
 
-                           error_index_tmp += 
-                                             (std::to_string(ref_seq_index) + " " +
-                                              std::to_string(current_index) + " " +
-                                              org_base                      + " " +
-                                              err_base                      + " " +
-                                              "Y CASE15"                    + " " +
-                                              read_name                     + " " +
-                                              std::to_string(start_index)   + " " +
-                                              std::to_string(end_index)     + "\n" 
-                                             );
+                           // CASE15
+                           append_error_index_record(error_index_tmp, current_index, org_base, err_base, 'Y');
                         }
                      }
                      // wrong  modification
@@ -2014,16 +2475,8 @@ inline void evaluate_each_alignment(std::string alignment1, std::string alignmen
                               exit(EXIT_FAILURE);
                            }
 
-                           error_index_tmp += 
-                                             (std::to_string(ref_seq_index) + " " +
-                                              std::to_string(current_index) + " " +
-                                              org_base                      + " " +
-                                              err_base                      + " " +
-                                              "N CASE16"                    + " " +
-                                              read_name                     + " " +
-                                              std::to_string(start_index)   + " " +
-                                              std::to_string(end_index)     + "\n" 
-                                             );
+                           // CASE16
+                           append_error_index_record(error_index_tmp, current_index, org_base, err_base, 'N');
                         }
                      }
                   }
@@ -2133,6 +2586,8 @@ inline void evaluate_each_alignment(std::string alignment1, std::string alignmen
 // find_best_alignment
 //
 void find_best_alignment(int* position_vector_local_best, int* corrected_position_vector_local_best) {
+   position_deltas_best.clear();
+
    // find out the highest alignment score
    highest_score = match_matrix[matrix_size - 1];
 
@@ -2145,8 +2600,8 @@ void find_best_alignment(int* position_vector_local_best, int* corrected_positio
    }
 
    // initialize variables
-   int index_x         = matrix_width - 1;
-   int index_y         = matrix_height - 1;
+   int index_x         = string1_length;
+   int index_y         = string2_length;
    int matrix_index    = matrix_size - 1;
    int alignment_index = longest_alignment_length - 1;
 
@@ -2162,31 +2617,62 @@ void find_best_alignment(int* position_vector_local_best, int* corrected_positio
 
    char current_matrix;
 
-   // the match array has the highest score
-   if (match_matrix[matrix_size - 1] == highest_score) {
-      current_matrix = 'M';
-      traceback(alignment1_tmp, alignment2_tmp, index_x, index_y, current_matrix, alignment_index, matrix_index, highest_score);
+   {
+      C_metrics_timer timer(METRICS_TRACEBACK);
+
+      // the match array has the highest score
+      if (match_matrix[matrix_size - 1] == highest_score) {
+         current_matrix = 'M';
+         traceback(alignment1_tmp, alignment2_tmp, index_x, index_y, current_matrix, alignment_index, matrix_index, highest_score);
+      }
+
+      // the match array has the highest score
+      if ((gap_1_matrix[matrix_size - 1] == highest_score) && (too_many_candidates == false)) {
+         current_matrix = '1';
+         traceback(alignment1_tmp, alignment2_tmp, index_x, index_y, current_matrix, alignment_index, matrix_index, highest_score);
+      }
+
+      // the match array has the highest score
+      if ((gap_2_matrix[matrix_size - 1] == highest_score) && (too_many_candidates == false)) {
+         current_matrix = '2';
+         traceback(alignment1_tmp, alignment2_tmp, index_x, index_y, current_matrix, alignment_index, matrix_index, highest_score);
+      }
    }
 
-   // the match array has the highest score
-   if ((gap_1_matrix[matrix_size - 1] == highest_score) && (too_many_candidates == false)) {
-      current_matrix = '1';
-      traceback(alignment1_tmp, alignment2_tmp, index_x, index_y, current_matrix, alignment_index, matrix_index, highest_score);
+   // candidate count distribution
+   if (too_many_candidates == true) {
+      metrics_num_too_many_candidates++;
    }
+   else {
+      if (metrics_candidate_histogram.size() <= alignment1_vector.size()) {
+         metrics_candidate_histogram.resize(alignment1_vector.size() + 1, 0.0);
+      }
 
-   // the match array has the highest score
-   if ((gap_2_matrix[matrix_size - 1] == highest_score) && (too_many_candidates == false)) {
-      current_matrix = '2';
-      traceback(alignment1_tmp, alignment2_tmp, index_x, index_y, current_matrix, alignment_index, matrix_index, highest_score);
+      metrics_candidate_histogram[alignment1_vector.size()]++;
    }
 
    // not too many candidates
    if (too_many_candidates == false) {
+      C_metrics_timer timer(METRICS_CLASSIFICATION);
+
       // evalute each alignment
       for (unsigned it_vec = 0; it_vec < alignment1_vector.size(); it_vec++) {
          evaluate_each_alignment(alignment1_vector[it_vec], alignment2_vector[it_vec], position_vector_local_best, corrected_position_vector_local_best);
       }
 
+      // changes of the histograms for the result cache
+      // <index>:<position delta>:<corrected position delta>;
+      if (is_cache == true) {
+         for (unsigned it_index = 0; it_index < position_vector_local_best_tmp.size(); it_index++) {
+            int position_delta           = position_vector_local_best_tmp[it_index]           - position_vector_local_best[it_index];
+            int corrected_position_delta = corrected_position_vector_local_best_tmp[it_index] - corrected_position_vector_local_best[it_index];
+
+            if ((position_delta != 0) || (corrected_position_delta != 0)) {
+               position_deltas_best += std::to_string(it_index) + ":" + std::to_string(position_delta) + ":" + std::to_string(corrected_position_delta) + ";";
+            }
+         }
+      }
+
       // update the histograms
       std::copy(position_vector_local_best_tmp.begin(),           position_vector_local_best_tmp.end(),           position_vector_local_best);
       std::copy(corrected_position_vector_local_best_tmp.begin(), corrected_position_vector_local_best_tmp.end(), corrected_position_vector_local_best);
@@ -2203,70 +2689,199 @@ void find_best_alignment(int* position_vector_local_best, int* corrected_positio
    delete[] gap_2_matrix;
 }
 
+//
+// apply_position_deltas
+// adds the histogram changes recorded in position_deltas_best of a cached read
+//
+void apply_position_deltas(std::string in_position_deltas, int* position_vector_local_best, int* corrected_position_vector_local_best) {
+   const char* cursor = in_position_deltas.c_str();
+
+   int index;
+   int position_delta;
+   int corrected_position_delta;
+   int num_chars;
+
+   while (sscanf(cursor, "%d:%d:%d;%n", &index, &position_delta, &corrected_position_delta, &num_chars) == 3) {
+      if ((index >= 0) && (index <= max_read_length)) {
+         position_vector_local_best[index]           += position_delta;
+         corrected_position_vector_local_best[index] += corrected_position_delta;
+      }
+
+      cursor += num_chars;
+   }
+}
+
 //
 // give_random_alignment
 //
 void give_random_alignment() {
-   // find out the highest alignment score
-   highest_score = match_matrix[matrix_size - 1];
+   corrected_read_length = string2.length();
+   outer_length_5_end    = outer_5_end.length();
+   outer_length_3_end    = outer_3_end.length();
 
-   if (gap_1_matrix[matrix_size - 1] > highest_score) {
-      highest_score = gap_1_matrix[matrix_size - 1];
+   // no alignment is made if there are too few overlaps between them
+   // random_alignment1/2 are empty in that case
+   {
+      C_metrics_timer timer(METRICS_TRACEBACK);
+
+      traceback_single_path(random_alignment1, random_alignment2);
    }
 
-   if (gap_2_matrix[matrix_size - 1] > highest_score) {
-      highest_score = gap_2_matrix[matrix_size - 1];
+   delete[] match_matrix;
+   delete[] gap_1_matrix;
+   delete[] gap_2_matrix;
+}
+
+//
+// count_percent_similarity
+// count aligned bases and matched bases in an alignment
+// leading and trailing gaps are not counted except the inserted bases at the ends
+// which are compared with the outer reference bases
+//
+void count_percent_similarity(const std::string& alignment1, const std::string& alignment2) {
+   // find indels at the ends of alignments
+   std::regex rx_5_prime_gap("^-+");
+   std::regex rx_3_prime_gap("-+$");
+
+   std::smatch smatch_5_prime_insertion;
+   std::smatch smatch_5_prime_deletion;
+   std::smatch smatch_3_prime_insertion;
+   std::smatch smatch_3_prime_deletion;
+
+   int num_insertions_5_prime;
+   int num_insertions_3_prime;
+   int num_deletions_5_prime;
+   int num_deletions_3_prime;
+
+   // 5'-end insertions
+   // -----AAA
+   // AAAAAAAA
+   if (std::regex_search(alignment1, smatch_5_prime_insertion, rx_5_prime_gap)) {
+      num_insertions_5_prime = smatch_5_prime_insertion[0].length();
+   }
+   else {
+      num_insertions_5_prime = 0;
    }
 
-   // initialize variables
-   int index_x         = matrix_width - 1;
-   int index_y         = matrix_height - 1;
-   int matrix_index    = matrix_size - 1;
-   int alignment_index = longest_alignment_length - 1;
+   // 5'-end deletions
+   // AAAAAAAA
+   // -----AAA
+   if (std::regex_search(alignment2, smatch_5_prime_deletion, rx_5_prime_gap)) {
+      num_deletions_5_prime = smatch_5_prime_deletion[0].length();
+   }
+   else {
+      num_deletions_5_prime = 0;
+   }
 
-   corrected_read_length = string2.length();
-   outer_length_5_end    = outer_5_end.length();
-   outer_length_3_end    = outer_3_end.length();
+   // 3'-end insertions
+   // AAA-----
+   // AAAAAAAA
+   if (std::regex_search(alignment1, smatch_3_prime_insertion, rx_3_prime_gap)) {
+      num_insertions_3_prime = smatch_3_prime_insertion[0].length();
+   }
+   else {
+      num_insertions_3_prime = 0;
+   }
 
-   std::string alignment1_tmp;
-   std::string alignment2_tmp;
+   // 3'-end deletions
+   // AAAAAAAA
+   // AAA-----
+   if (std::regex_search(alignment2, smatch_3_prime_deletion, rx_3_prime_gap)) {
+      num_deletions_3_prime = smatch_3_prime_deletion[0].length();
+   }
+   else {
+      num_deletions_3_prime = 0;
+   }
 
-   alignment1_tmp.resize(longest_alignment_length);
-   alignment2_tmp.resize(longest_alignment_length);
+   //----------------------------------------------------------------------
+   // calculate percent similarity
+   //----------------------------------------------------------------------
+   num_total_bases_percent_similarity   = 0;
+   num_matched_bases_percent_similarity = 0;
 
-   char current_matrix;
+   //
+   // main region
+   //
+   int start_index;
+   int end_index;
 
-   // the match array has the highest score
-   if (match_matrix[matrix_size - 1] == highest_score) {
-      current_matrix = 'M';
-      traceback(alignment1_tmp, alignment2_tmp, index_x, index_y, current_matrix, alignment_index, matrix_index, highest_score);
+   start_index = std::max(num_insertions_5_prime, num_deletions_5_prime);
+   end_index   = alignment1.length() - std::max(num_insertions_3_prime, num_deletions_3_prime) - 1;
+
+   for (int it_alignment = start_index; it_alignment <= end_index; it_alignment++) {
+      num_total_bases_percent_similarity++;
+
+      if (alignment1[it_alignment] == alignment2[it_alignment]) {
+         num_matched_bases_percent_similarity++;
+      }
    }
 
-   // the match array has the highest score
-   if (alignment1_vector.size() == 0) {
-      if ((gap_1_matrix[matrix_size - 1] == highest_score) && (too_many_candidates == false)) {
-         current_matrix = '1';
-         traceback(alignment1_tmp, alignment2_tmp, index_x, index_y, current_matrix, alignment_index, matrix_index, highest_score);
+   //
+   // insertions at the 3'-end
+   //
+   // AAA---
+   // AAAAAA
+   // use the first three bases of outer_3_end
+   if (num_insertions_3_prime > 0) {
+      for (std::size_t it_alignment = (alignment1.length() - num_insertions_3_prime); it_alignment < alignment1.length(); it_alignment++) {
+         num_total_bases_percent_similarity++;
+
+         if (outer_3_end[it_alignment] == alignment2[it_alignment]) {
+            num_matched_bases_percent_similarity++;
+         }
       }
    }
 
-   // the match array has the highest score
-   if (alignment1_vector.size() == 0) {
-      if ((gap_2_matrix[matrix_size - 1] == highest_score) && (too_many_candidates == false)) {
-         current_matrix = '2';
-         traceback(alignment1_tmp, alignment2_tmp, index_x, index_y, current_matrix, alignment_index, matrix_index, highest_score);
+   //
+   // insertions at the 5'-end
+   //
+   // ---AAA
+   // AAAAAA
+   // use the last three bases of outer_5_end
+   if (num_insertions_5_prime > 0) {
+      for (int it_alignment = 0; it_alignment < num_insertions_5_prime; it_alignment++) {
+         num_total_bases_percent_similarity++;
+
+         if (outer_5_end[outer_5_end.length() - num_insertions_5_prime + it_alignment] == alignment2[it_alignment]) {
+            num_matched_bases_percent_similarity++;
+         }
       }
    }
+}
+
+//
+// calculate_percent_similarity
+//
+void calculate_percent_similarity() {
+   corrected_read_length = string2.length();
+   outer_length_5_end    = outer_5_end.length();
+   outer_length_3_end    = outer_3_end.length();
+
+   std::string alignment1;
+   std::string alignment2;
+
+   bool aligned;
+
+   {
+      C_metrics_timer timer(METRICS_TRACEBACK);
+
+      aligned = traceback_single_path(alignment1, alignment2);
+   }
 
    // no alignment is made
    // because there are too few overlaps between them
-   if (alignment1_vector.size() == 0) {
-      random_alignment1 = "";
-      random_alignment2 = "";
+   if (aligned == false) {
+      num_total_bases_percent_similarity   = 0;
+      num_matched_bases_percent_similarity = 0;
+
+      alignment_best = "NO ALIGNMENT\n";
    }
    else {
-      random_alignment1 = alignment1_vector[0];
-      random_alignment2 = alignment2_vector[0];
+      C_metrics_timer timer(METRICS_CLASSIFICATION);
+
+      count_percent_similarity(alignment1, alignment2);
+
+      alignment_best = alignment1 + "\n" + alignment2 + "\n";
    }
 
    delete[] match_matrix;
@@ -2275,183 +2890,573 @@ void give_random_alignment() {
 }
 
 //
-// calculate_percent_similarity
+// compute_bit_parallel_column
+// computes the delta vectors of a column from those of the previous column
+// pv/mv: vertical +1/-1, ph/mh: horizontal +1/-1
+// returns the horizontal delta of the last row
 //
-void calculate_percent_similarity() {
-   // main region
-   // find out the highest alignment score
-   highest_score = match_matrix[matrix_size - 1];
+inline int compute_bit_parallel_column(const uint64_t* eq_vector, const uint64_t* prev_pv, const uint64_t* prev_mv, uint64_t* pv, uint64_t* mv, uint64_t* ph, uint64_t* mh, int num_blocks, int last_block_bit) {
+   const int word_size(64);
 
-   if (gap_1_matrix[matrix_size - 1] > highest_score) {
-      highest_score = gap_1_matrix[matrix_size - 1];
+   // D[0][x] = x or 0
+   int h_in(no_end_gap_penalty ? 0 : 1);
+   int last_row_delta(0);
+
+   for (int it_block = 0; it_block < num_blocks; it_block++) {
+      uint64_t pv_block = prev_pv[it_block];
+      uint64_t mv_block = prev_mv[it_block];
+      uint64_t eq       = eq_vector[it_block];
+
+      uint64_t xv = eq | mv_block;
+
+      if (h_in < 0) {
+         eq |= 1;
+      }
+
+      uint64_t xh       = (((eq & pv_block) + pv_block) ^ pv_block) | eq;
+      uint64_t ph_block = mv_block | ~(xh | pv_block);
+      uint64_t mh_block = pv_block & xh;
+
+      ph[it_block] = ph_block;
+      mh[it_block] = mh_block;
+
+      // the last row of string2
+      if (it_block == num_blocks - 1) {
+         last_row_delta = (int)((ph_block >> last_block_bit) & 1) - (int)((mh_block >> last_block_bit) & 1);
+      }
+
+      int h_out(0);
+
+      if (ph_block >> (word_size - 1)) {
+         h_out = 1;
+      }
+      else if (mh_block >> (word_size - 1)) {
+         h_out = -1;
+      }
+
+      ph_block <<= 1;
+      mh_block <<= 1;
+
+      if (h_in < 0) {
+         mh_block |= 1;
+      }
+      else if (h_in > 0) {
+         ph_block |= 1;
+      }
+
+      pv[it_block] = mh_block | ~(xv | ph_block);
+      mv[it_block] = ph_block & xv;
+
+      h_in = h_out;
    }
 
-   if (gap_2_matrix[matrix_size - 1] > highest_score) {
-      highest_score = gap_2_matrix[matrix_size - 1];
+   return last_row_delta;
+}
+
+//
+// align_bit_parallel
+//
+// scoring model
+// unit-cost edit distance: a match costs 0 and a mismatch, an inserted base, or a deleted base costs 1
+// gaps are linear, and match_gain, mismatch_penalty, and the gap penalties are not used
+// string2 (the corrected read) is always aligned end to end
+// the bases of string1 before and after the aligned region are free if no_end_gap_penalty is true
+//
+// string2 is the pattern and string1 is the text of Myers' bit-vector algorithm (Hyyro's blocked variant)
+// 64 rows of each column are computed at a time
+//
+// memory
+// the delta vectors of all the columns are kept for the traceback
+// if they are larger than bit_parallel_max_vector_bytes, the columns are cut into segments of
+// get_bit_parallel_segment_length columns, only the vertical delta vectors of the first column of
+// each segment are kept, and the segments are computed again one at a time during the traceback
+//
+// tie-breaking order
+// 1. the last column of string1: the leftmost one among the columns with the lowest distance
+// 2. the previous cell         : diagonal -> gap in string1 -> gap in string2
+//
+// return value
+// true : alignment1/2 are filled
+// false: the overlap between string1 and string2 is shorter than MIN_OVERLAP
+//        or the traceback reaches a dead end, which is counted in num_bit_parallel_dead_ends
+//
+bool align_bit_parallel(std::string& alignment1, std::string& alignment2) {
+   C_metrics_timer timer_fill(METRICS_DP_FILL);
+
+   const int word_size(64);
+
+   int num_blocks((string2_length + word_size - 1) / word_size);
+
+   alignment1.clear();
+   alignment2.clear();
+
+   if (num_blocks == 0) {
+      return false;
    }
 
-   // initialize variables
-   int index_x         = matrix_width - 1;
-   int index_y         = matrix_height - 1;
-   int matrix_index    = matrix_size - 1;
-   int alignment_index = longest_alignment_length - 1;
+   // match vectors of each character
+   std::vector<uint64_t> peq(256 * num_blocks, 0);
 
-   corrected_read_length = string2.length();
-   outer_length_5_end    = outer_5_end.length();
-   outer_length_3_end    = outer_3_end.length();
+   for (int it_y = 0; it_y < string2_length; it_y++) {
+      peq[(unsigned char)string2[it_y] * num_blocks + it_y / word_size] |= ((uint64_t)1 << (it_y % word_size));
+   }
 
-   std::string alignment1_tmp;
-   std::string alignment2_tmp;
+   // delta vectors of the columns in the current segment: [segment_start, segment_start + segment_length]
+   int segment_length(get_bit_parallel_segment_length(string1_length, string2_length));
+   int segment_start(0);
+   int segment_size((segment_length + 1) * num_blocks);
 
-   alignment1_tmp.resize(longest_alignment_length);
-   alignment2_tmp.resize(longest_alignment_length);
+   std::vector<uint64_t> pv(segment_size);
+   std::vector<uint64_t> mv(segment_size);
+   std::vector<uint64_t> ph(segment_size);
+   std::vector<uint64_t> mh(segment_size);
 
-   char current_matrix;
+   // vertical delta vectors of the first column of each segment
+   int num_segments((string1_length + segment_length - 1) / segment_length);
 
-   // the match array has the highest score
-   if (match_matrix[matrix_size - 1] == highest_score) {
-      current_matrix = 'M';
-      traceback(alignment1_tmp, alignment2_tmp, index_x, index_y, current_matrix, alignment_index, matrix_index, highest_score);
+   std::vector<uint64_t> checkpoint_pv;
+   std::vector<uint64_t> checkpoint_mv;
+
+   if (num_segments > 1) {
+      checkpoint_pv.resize(num_segments * num_blocks);
+      checkpoint_mv.resize(num_segments * num_blocks);
    }
 
-   // the match array has the highest score
-   if (alignment1_vector.size() == 0) {
-      if ((gap_1_matrix[matrix_size - 1] == highest_score) && (too_many_candidates == false)) {
-         current_matrix = '1';
-         traceback(alignment1_tmp, alignment2_tmp, index_x, index_y, current_matrix, alignment_index, matrix_index, highest_score);
+   // distance between string2 and string1[0, it_x) in the last row
+   std::vector<int> last_row(string1_length + 1);
+
+   // column 0: D[y][0] = y
+   for (int it_block = 0; it_block < num_blocks; it_block++) {
+      pv[it_block] = ~(uint64_t)0;
+      mv[it_block] = 0;
+   }
+
+   last_row[0] = string2_length;
+
+   int last_block_bit((string2_length - 1) % word_size);
+
+   for (int it_x = 1; it_x <= string1_length; it_x++) {
+      // start a new segment
+      // the last column of the previous segment is the first column of the new one
+      if (it_x - segment_start > segment_length) {
+         std::copy(pv.begin() + segment_length * num_blocks, pv.end(), pv.begin());
+         std::copy(mv.begin() + segment_length * num_blocks, mv.end(), mv.begin());
+
+         segment_start += segment_length;
       }
+
+      if ((segment_start == it_x - 1) && (num_segments > 1)) {
+         std::copy(pv.begin(), pv.begin() + num_blocks, checkpoint_pv.begin() + (segment_start / segment_length) * num_blocks);
+         std::copy(mv.begin(), mv.begin() + num_blocks, checkpoint_mv.begin() + (segment_start / segment_length) * num_blocks);
+      }
+
+      int prev_column(num_blocks * (it_x - 1 - segment_start));
+      int column(num_blocks * (it_x - segment_start));
+
+      last_row[it_x] = last_row[it_x - 1] + compute_bit_parallel_column(&peq[(unsigned char)string1[it_x - 1] * num_blocks],
+                                                                        &pv[prev_column], &mv[prev_column],
+                                                                        &pv[column], &mv[column], &ph[column], &mh[column],
+                                                                        num_blocks, last_block_bit);
    }
 
-   // the match array has the highest score
-   if (alignment1_vector.size() == 0) {
-      if ((gap_2_matrix[matrix_size - 1] == highest_score) && (too_many_candidates == false)) {
-         current_matrix = '2';
-         traceback(alignment1_tmp, alignment2_tmp, index_x, index_y, current_matrix, alignment_index, matrix_index, highest_score);
+   // find the last column
+   int index_x(string1_length);
+
+   if (no_end_gap_penalty) {
+      index_x = 0;
+
+      for (int it_x = 1; it_x <= string1_length; it_x++) {
+         if (last_row[it_x] < last_row[index_x]) {
+            index_x = it_x;
+         }
+      }
+   }
+
+   // every cell is computed 64 rows at a time
+   metrics_num_dp_cells += (double)string1_length * string2_length;
+
+   timer_fill.stop();
+
+   //----------------------------------------------------------------------
+   // traceback
+   //----------------------------------------------------------------------
+   C_metrics_timer timer_traceback(METRICS_TRACEBACK);
+
+   // alignments are built in reverse order
+   int index_y(string2_length);
+   int current_score(last_row[index_x]);
+   int num_diagonals(0);
+
+   // deletions at the 3'-end
+   for (int it_x = string1_length; it_x > index_x; it_x--) {
+      alignment1.push_back(string1[it_x - 1]);
+      alignment2.push_back('-');
+   }
+
+   while ((index_x > 0) && (index_y > 0)) {
+      // columns index_x - 1 and index_x are not in the current segment
+      // compute the segment again from its first column
+      if ((index_x - 1 < segment_start) || (index_x > segment_start + segment_length)) {
+         segment_start = ((index_x - 1) / segment_length) * segment_length;
+
+         std::copy(checkpoint_pv.begin() + (segment_start / segment_length) * num_blocks, checkpoint_pv.begin() + (segment_start / segment_length + 1) * num_blocks, pv.begin());
+         std::copy(checkpoint_mv.begin() + (segment_start / segment_length) * num_blocks, checkpoint_mv.begin() + (segment_start / segment_length + 1) * num_blocks, mv.begin());
+
+         for (int it_x = segment_start + 1; it_x <= std::min(segment_start + segment_length, string1_length); it_x++) {
+            int prev_column(num_blocks * (it_x - 1 - segment_start));
+            int column(num_blocks * (it_x - segment_start));
+
+            compute_bit_parallel_column(&peq[(unsigned char)string1[it_x - 1] * num_blocks],
+                                        &pv[prev_column], &mv[prev_column],
+                                        &pv[column], &mv[column], &ph[column], &mh[column],
+                                        num_blocks, last_block_bit);
+         }
+
+         metrics_num_dp_cells += (double)segment_length * string2_length;
+      }
+
+      int block((index_y - 1) / word_size);
+      int bit((index_y - 1) % word_size);
+
+      int column(num_blocks * (index_x - segment_start) + block);
+      int prev_column(num_blocks * (index_x - 1 - segment_start) + block);
+
+      int v_delta((int)((pv[column] >> bit) & 1) - (int)((mv[column] >> bit) & 1));
+      int h_delta((int)((ph[column] >> bit) & 1) - (int)((mh[column] >> bit) & 1));
+      int v_delta_left((int)((pv[prev_column] >> bit) & 1) - (int)((mv[prev_column] >> bit) & 1));
+
+      int score_up(current_score - v_delta);
+      int score_left(current_score - h_delta);
+      int score_diagonal(score_left - v_delta_left);
+
+      // diagonal
+      if (score_diagonal + (string1[index_x - 1] == string2[index_y - 1] ? 0 : 1) == current_score) {
+         alignment1.push_back(string1[index_x - 1]);
+         alignment2.push_back(string2[index_y - 1]);
+
+         current_score = score_diagonal;
+         index_x--;
+         index_y--;
+         num_diagonals++;
+      }
+      // gap in string1
+      else if (score_up + 1 == current_score) {
+         alignment1.push_back('-');
+         alignment2.push_back(string2[index_y - 1]);
+
+         current_score = score_up;
+         index_y--;
+      }
+      // gap in string2
+      else if (score_left + 1 == current_score) {
+         alignment1.push_back(string1[index_x - 1]);
+         alignment2.push_back('-');
+
+         current_score = score_left;
+         index_x--;
+      }
+      // this should not happen
+      // the read is reported as not aligned instead of terminating the whole run
+      else {
+         num_bit_parallel_dead_ends++;
+
+         alignment1.clear();
+         alignment2.clear();
+
+         return false;
       }
    }
 
+   // gap in string1
+   while(index_y > 0) {
+      alignment1.push_back('-');
+      alignment2.push_back(string2[index_y - 1]);
+
+      index_y--;
+   }
+
+   // gap in string2
+   while(index_x > 0) {
+      alignment1.push_back(string1[index_x - 1]);
+      alignment2.push_back('-');
+
+      index_x--;
+   }
+
+   // too few overlaps between two sequences
+   if (num_diagonals < MIN_OVERLAP) {
+      alignment1.clear();
+      alignment2.clear();
+
+      return false;
+   }
+
+   std::reverse(alignment1.begin(), alignment1.end());
+   std::reverse(alignment2.begin(), alignment2.end());
+
+   return true;
+}
+
+//
+// calculate_percent_similarity_bit_parallel
+// same as calculate_percent_similarity but the alignment is made using align_bit_parallel
+// fill_matrixes should not be called before this function
+//
+void calculate_percent_similarity_bit_parallel() {
+   corrected_read_length = string2.length();
+   outer_length_5_end    = outer_5_end.length();
+   outer_length_3_end    = outer_3_end.length();
+
+   std::string alignment1;
+   std::string alignment2;
+
    // no alignment is made
    // because there are too few overlaps between them
-   if (alignment1_vector.size() == 0) {
+   if (align_bit_parallel(alignment1, alignment2) == false) {
       num_total_bases_percent_similarity   = 0;
       num_matched_bases_percent_similarity = 0;
 
       alignment_best = "NO ALIGNMENT\n";
    }
    else {
-      // find indels at the ends of alignments
-      std::regex rx_5_prime_gap("^-+");
-      std::regex rx_3_prime_gap("-+$");
-
-      std::smatch smatch_5_prime_insertion;
-      std::smatch smatch_5_prime_deletion;
-      std::smatch smatch_3_prime_insertion;
-      std::smatch smatch_3_prime_deletion;
-
-      int num_insertions_5_prime;
-      int num_insertions_3_prime;
-      int num_deletions_5_prime;
-      int num_deletions_3_prime;
-
-      // 5'-end insertions
-      // -----AAA
-      // AAAAAAAA
-      if (std::regex_search(alignment1_vector[0], smatch_5_prime_insertion, rx_5_prime_gap)) {
-         num_insertions_5_prime = smatch_5_prime_insertion[0].length();
-      }
-      else {
-         num_insertions_5_prime = 0;
+      C_metrics_timer timer(METRICS_CLASSIFICATION);
+
+      count_percent_similarity(alignment1, alignment2);
+
+      alignment_best = alignment1 + "\n" + alignment2 + "\n";
+   }
+}
+
+//
+// decode_substitutions
+// same as the substitution part of decode_errors but without std::regex
+// <1-based index>:<original base>-><erroneous base>;
+//
+void decode_substitutions() {
+   substitution_index_vector.clear();
+   substitution_org_bases.clear();
+   substitution_err_bases.clear();
+
+   if (substitutions == "-") {
+      return;
+   }
+
+   const char* current_char = substitutions.c_str();
+
+   while (*current_char != '\0') {
+      // index
+      if ((*current_char < '0') || (*current_char > '9')) {
+         current_char++;
+         continue;
       }
 
-      // 5'-end deletions
-      // AAAAAAAA
-      // -----AAA
-      if (std::regex_search(alignment2_vector[0], smatch_5_prime_deletion, rx_5_prime_gap)) {
-         num_deletions_5_prime = smatch_5_prime_deletion[0].length();
+      int index(0);
+
+      while ((*current_char >= '0') && (*current_char <= '9')) {
+         index = index * 10 + (*current_char - '0');
+         current_char++;
       }
-      else {
-         num_deletions_5_prime = 0;
+
+      // :<org>-><err>;
+      if ((current_char[0] == ':') && (current_char[1] != '\0') && (current_char[2] == '-') && (current_char[3] == '>') && (current_char[4] != '\0') && (current_char[5] == ';')) {
+         substitution_index_vector.push_back(index);
+         substitution_org_bases.push_back(current_char[1]);
+         substitution_err_bases.push_back(current_char[4]);
+
+         current_char += 6;
       }
+   }
+}
+
+//
+// count_mismatches
+// compares eight bases at a time
+//
+inline int count_mismatches(const char* sequence1, const char* sequence2, int length) {
+   int num_mismatches(0);
+   int it_base(0);
+
+   for (; it_base + 8 <= length; it_base += 8) {
+      uint64_t word1;
+      uint64_t word2;
+
+      memcpy(&word1, sequence1 + it_base, 8);
+      memcpy(&word2, sequence2 + it_base, 8);
+
+      uint64_t difference(word1 ^ word2);
 
-      // 3'-end insertions
-      // AAA-----
-      // AAAAAAAA
-      if (std::regex_search(alignment1_vector[0], smatch_3_prime_insertion, rx_3_prime_gap)) {
-         num_insertions_3_prime = smatch_3_prime_insertion[0].length();
+      if (difference != 0) {
+         // the lowest bit of each byte = 1 if the byte is different
+         difference |= (difference >> 4);
+         difference |= (difference >> 2);
+         difference |= (difference >> 1);
+         difference &= 0x0101010101010101ULL;
+
+         num_mismatches += (int)((difference * 0x0101010101010101ULL) >> 56);
       }
-      else {
-         num_insertions_3_prime = 0;
+   }
+
+   for (; it_base < length; it_base++) {
+      if (sequence1[it_base] != sequence2[it_base]) {
+         num_mismatches++;
       }
+   }
+
+   return num_mismatches;
+}
+
+//
+// add_substitution_error_index
+// appends a record to error_index_best
+// corrected_case: "<Y or N> <case>"
+//
+inline void add_substitution_error_index(int index, char org_base, char err_base, const char* corrected_case) {
+   int current_index;
+
+   // calculate the index of the error in the reference sequence
+   if (strand == "+") {
+      // both start_index and index are 1-based
+      current_index = start_index + index - 1;
+   }
+   else if (strand == "-") {
+      // both end_index and index are 1-based
+      current_index = end_index - index + 1;
+
+      org_base = complement_base(org_base);
+      err_base = complement_base(err_base);
+   }
+   else {
+      std::cout << "\nERROR: Illegal strand " << strand << "\n\n";
+      exit(EXIT_FAILURE);
+   }
+
+   append_error_index_record(error_index_best, current_index, org_base, err_base, corrected_case[0]);
+}
+
+//
+// count_unchanged_read_errors
+// a corrected read is same as an original read
+// every substitution in the original read remains (nnn)
+//
+void count_unchanged_read_errors(int* position_vector_local) {
+   C_metrics_timer timer(METRICS_CLASSIFICATION);
+
+   decode_substitutions();
 
-      // 3'-end deletions
-      // AAAAAAAA
-      // AAA-----
-      if (std::regex_search(alignment2_vector[0], smatch_3_prime_deletion, rx_3_prime_gap)) {
-         num_deletions_3_prime = smatch_3_prime_deletion[0].length();
+   error_index_best.clear();
+
+   for (unsigned int it_substitution = 0; it_substitution < substitution_index_vector.size(); it_substitution++) {
+      // update the position vector
+      position_vector_local[substitution_index_vector[it_substitution]]++;
+
+      if (is_detail) {
+         add_substitution_error_index(substitution_index_vector[it_substitution], substitution_org_bases[it_substitution], substitution_err_bases[it_substitution], "N CASE01");
       }
-      else {
-         num_deletions_3_prime = 0;
+   }
+}
+
+//
+// evaluate_substitution_only
+// neither the original read nor the corrected read has indels
+// string1: reference sequence
+// string2: corrected read
+// the two strings have the same length
+//
+void evaluate_substitution_only(int* position_vector_local, int* corrected_position_vector_local) {
+   C_metrics_timer timer(METRICS_CLASSIFICATION);
+
+   if (string1.length() != string2.length()) {
+      std::cout << "\nERROR: Lengths of the reference sequence and the corrected read are different for " << read_name << "\n\n";
+      exit(EXIT_FAILURE);
+   }
+
+   decode_substitutions();
+
+   error_index_best.clear();
+
+   num_yyns_substitution_local_best = 0;
+   num_ynys_substitution_local_best = 0;
+   num_nyys_substitution_local_best = 0;
+   num_nyns_substitution_local_best = 0;
+   num_nnns_substitution_local_best = 0;
+
+   int length(string1.length());
+
+   // mismatches between the reference sequence and the corrected read
+   int num_mismatches(count_mismatches(string1.c_str(), string2.c_str(), length));
+
+   //
+   // errors in the original read (nXX)
+   //
+   int num_errors(0);
+   int num_mismatches_at_errors(0);
+
+   for (unsigned int it_substitution = 0; it_substitution < substitution_index_vector.size(); it_substitution++) {
+      // 1-based
+      int index(substitution_index_vector[it_substitution]);
+
+      if ((index < 1) || (index > length)) {
+         continue;
       }
 
-      //----------------------------------------------------------------------
-      // calculate percent similarity
-      //----------------------------------------------------------------------
-      num_total_bases_percent_similarity   = 0;
-      num_matched_bases_percent_similarity = 0;
+      num_errors++;
 
-      //
-      // main region
-      //
-      int start_index;
-      int end_index;
+      char base1(string1[index - 1]);
+      char base2(string2[index - 1]);
 
-      start_index = std::max(num_insertions_5_prime, num_deletions_5_prime);
-      end_index   = alignment1_vector[0].length() - std::max(num_insertions_3_prime, num_deletions_3_prime) - 1;
+      // correctly modified
+      if (base1 == base2) {
+         num_nyys_substitution_local_best++;
 
-      for (int it_alignment = start_index; it_alignment <= end_index; it_alignment++) {
-         num_total_bases_percent_similarity++;
+         // update position vectors
+         position_vector_local[index]++;
+         corrected_position_vector_local[index]++;
 
-         if (alignment1_vector[0][it_alignment] == alignment2_vector[0][it_alignment]) {
-            num_matched_bases_percent_similarity++;
+         if (is_detail) {
+            add_substitution_error_index(index, substitution_org_bases[it_substitution], substitution_err_bases[it_substitution], "Y CASE02");
          }
       }
+      else {
+         num_mismatches_at_errors++;
 
-      //
-      // insertions at the 3'-end
-      //
-      // AAA---
-      // AAAAAA
-      // use the first three bases of outer_3_end
-      if (num_insertions_3_prime > 0) {
-         for (int it_alignment = (alignment1_vector[0].length() - num_insertions_3_prime); it_alignment < alignment1_vector[0].length(); it_alignment++) {
-            num_total_bases_percent_similarity++;
-
-            if (outer_3_end[it_alignment] == alignment2_vector[0][it_alignment]) {
-               num_matched_bases_percent_similarity++;
+         position_vector_local[index]++;
+
+         // not modified
+         if (base2 == substitution_err_bases[it_substitution]) {
+            num_nnns_substitution_local_best++;
+
+            if (is_detail) {
+               add_substitution_error_index(index, substitution_org_bases[it_substitution], substitution_err_bases[it_substitution], "N CASE03");
             }
          }
-      }
+         // modified but the result is wrong
+         else {
+            num_nyns_substitution_local_best++;
 
-      //
-      // insertions at the 5'-end
-      //
-      // ---AAA
-      // AAAAAA
-      // use the last three bases of outer_5_end
-      if (num_insertions_5_prime > 0) {
-         for (int it_alignment = 0; it_alignment < num_insertions_5_prime; it_alignment++) {
-            num_total_bases_percent_similarity++;
-
-            if (outer_5_end[outer_5_end.length() - num_insertions_5_prime + it_alignment] == alignment2_vector[0][it_alignment]) {
-               num_matched_bases_percent_similarity++;
+            if (is_detail) {
+               add_substitution_error_index(index, substitution_org_bases[it_substitution], substitution_err_bases[it_substitution], "N CASE04");
             }
          }
       }
-
-      alignment_best = alignment1_vector[0] + "\n" + alignment2_vector[0] + "\n";
    }
 
-   delete[] match_matrix;
-   delete[] gap_1_matrix;
-   delete[] gap_2_matrix;
+   //
+   // no error in the original read (yXX)
+   //
+   num_yyns_substitution_local_best = num_mismatches - num_mismatches_at_errors;
+   num_ynys_substitution_local_best = length - num_errors - num_yyns_substitution_local_best;
+}
+
+//
+// calculate_percent_similarity_substitution
+// percent similarity without an alignment
+// string1 and string2 have the same length
+//
+void calculate_percent_similarity_substitution() {
+   C_metrics_timer timer(METRICS_CLASSIFICATION);
+
+   int length(std::min(string1.length(), string2.length()));
+
+   num_total_bases_percent_similarity   = string1.length();
+   num_matched_bases_percent_similarity = length - count_mismatches(string1.c_str(), string2.c_str(), length);
 }
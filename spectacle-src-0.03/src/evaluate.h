@@ -0,0 +1,110 @@
+// CONTACT: yunheo1@illinois.edu
+
+#ifndef EVALUATE_H
+#define EVALUATE_H
+
+#include <string>
+
+
+
+//----------------------------------------------------------------------
+// variables
+// defined in evaluate.cpp
+// lib/evaluate.i exposes them to evaluate.dna
+//----------------------------------------------------------------------
+extern int end_index;
+extern int read_length;
+extern int start_index;
+extern int gap_extension_penalty;
+extern int gap_opening_penalty;
+extern int match_gain;
+extern int mismatch_penalty;
+extern int max_read_length;
+extern int num_yyns_substitution_local_best;
+extern int num_ynys_substitution_local_best;
+extern int num_nyys_substitution_local_best;
+extern int num_nyns_substitution_local_best;
+extern int num_nnns_substitution_local_best;
+extern int num_yyns_insertion_local_best;
+extern int num_nyys_insertion_local_best;
+extern int num_nyns_insertion_local_best;
+extern int num_nnns_insertion_local_best;
+extern int num_yyns_deletion_local_best;
+extern int num_nyys_deletion_local_best;
+extern int num_nyns_deletion_local_best;
+extern int num_nnns_deletion_local_best;
+extern int num_from_substitution_to_deletion_local_best;
+extern int num_nyys_substitution_trim_local_best;
+extern int num_nyys_insertion_trim_local_best;
+extern int num_nyys_deletion_trim_local_best;
+extern int num_not_evaluated_substitution;
+extern int num_not_evaluated_insertion;
+extern int num_not_evaluated_deletion;
+extern int num_total_bases_percent_similarity;
+extern int num_matched_bases_percent_similarity;
+extern int num_bit_parallel_dead_ends;
+extern int ref_seq_index;
+
+extern unsigned int max_candidates;
+
+extern std::string outer_3_end;
+extern std::string outer_5_end;
+extern std::string read_name;
+extern std::string string1;
+extern std::string string2;
+extern std::string substitutions;
+extern std::string insertions;
+extern std::string deletions;
+extern std::string alignment_best;
+extern std::string error_index_best;
+extern std::string position_deltas_best;
+extern std::string random_alignment1;
+extern std::string random_alignment2;
+extern std::string strand;
+
+extern bool is_cache;
+extern bool is_detail;
+extern bool is_trimmed;
+extern bool no_end_gap_penalty;
+extern bool too_many_candidates;
+extern bool use_wavefront;
+
+// used by check-bit-parallel
+extern double bit_parallel_max_vector_bytes;
+
+
+
+//----------------------------------------------------------------------
+// functions
+//----------------------------------------------------------------------
+void initialize_variables();
+void decode_errors();
+void debug_print_variables();
+void fill_matrixes();
+void find_best_alignment(int* position_vector_local_best, int* corrected_position_vector_local_best);
+void apply_position_deltas(std::string in_position_deltas, int* position_vector_local_best, int* corrected_position_vector_local_best);
+void print_matrixes();
+void give_random_alignment();
+void calculate_percent_similarity();
+void calculate_percent_similarity_bit_parallel();
+void count_unchanged_read_errors(int* position_vector_local);
+void evaluate_substitution_only(int* position_vector_local, int* corrected_position_vector_local);
+void calculate_percent_similarity_substitution();
+double get_peak_rss();
+double get_bytes_read();
+double estimate_dp_memory(int in_string1_length, int in_string2_length);
+double estimate_bit_parallel_memory(int in_string1_length, int in_string2_length);
+int metrics_num_stages();
+std::string metrics_stage_name(int stage);
+double metrics_stage_wall_time(int stage);
+double metrics_stage_cpu_time(int stage);
+double metrics_stage_calls(int stage);
+double metrics_dp_cells();
+double metrics_too_many_candidates();
+int metrics_candidate_histogram_size();
+double metrics_candidate_histogram_count(int num_candidates);
+
+// used by check-bit-parallel
+bool align_bit_parallel(std::string& alignment1, std::string& alignment2);
+
+#endif
@@ -0,0 +1,621 @@
+// CONTACT: yunheo1@illinois.edu
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include "ordered-pipeline.h"
+
+// number of read pairs read by the reader thread at a time
+#define PAIR_BATCH_SIZE 10000
+
+// progress is printed every this number of read pairs
+#define PROGRESS_INTERVAL 100000
+
+
+
+//----------------------------------------------------------------------
+// a location line
+// <read name> <ref 1 or 2> <ref name> <strand> <start index> <read length> <substitutions> <insertions> <deletions>
+//----------------------------------------------------------------------
+struct C_location_record {
+   std::string read_name;
+   char        genome;
+   std::string seq_name;
+   char        strand;
+   long        position;
+   long        read_length;
+   std::string insertions;
+   std::string deletions;
+};
+
+
+
+//----------------------------------------------------------------------
+// location records of read pairs and their fastq records
+//----------------------------------------------------------------------
+struct C_batch {
+   std::vector<C_location_record> records;
+   std::string                    fastq1;
+   std::string                    fastq2;
+};
+
+
+
+//----------------------------------------------------------------------
+// reference sequences in upper case
+//----------------------------------------------------------------------
+typedef std::unordered_map<std::string, std::string> T_ref_map;
+
+
+
+//----------------------------------------------------------------------
+// reader, worker, and writer threads
+// batches are extracted in any order but written in the input order
+//----------------------------------------------------------------------
+class C_read_generator : public C_ordered_pipeline<C_batch> {
+   private:
+      std::ifstream& f_location;
+      std::ofstream& f_fastq1;
+      std::ofstream& f_fastq2;
+
+      const char* location_file_name;
+
+      const T_ref_map& ref_1;
+      const T_ref_map& ref_2;
+      bool             has_ref_2;
+
+      char quality_score;
+
+      // read pairs written to the fastq files
+      std::size_t num_pairs_done;
+
+      bool read_batch(C_batch& batch);
+      void process_batch(C_batch& batch, const std::size_t& thread_id);
+      void write_batch(C_batch& batch);
+      void extract_sequence(const C_location_record& record, std::string& fastq);
+
+   public:
+      std::size_t num_pairs;
+
+      C_read_generator(std::ifstream& in_f_location, std::ofstream& in_f_fastq1, std::ofstream& in_f_fastq2, const char* in_location_file_name, const T_ref_map& in_ref_1, const T_ref_map& in_ref_2, const bool& in_has_ref_2, const char& in_quality_score, const std::size_t& in_num_threads);
+};
+
+
+
+void read_ref_sequence(const char* ref_file_name, T_ref_map& ref_map);
+void split_line(const std::string& line, std::vector<std::string>& fields);
+bool parse_location_line(const std::string& line, C_location_record& record);
+bool is_na_line(const std::string& line);
+long count_insertions(const std::string& insertions);
+long count_deletions(const std::string& deletions);
+
+
+
+// complementary bases
+// characters other than A, C, G, and T are not changed
+static char complement_table[256];
+
+
+
+int main (int argc, char** argv) {
+   // check the number of arguments
+   if (argc != 8) {
+      std::cout << std::endl << "USAGE: " << argv[0] << " <location file> <reference fasta file 1> <reference fasta file 2|-> <output fastq file 1> <output fastq file 2> <33|64: quality score offset> <number of threads|0: all cores>" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   // quality score of the error-free reads
+   char quality_score;
+
+   if (atoi(argv[6]) == 33) {
+      quality_score = 'I';
+   }
+   else if (atoi(argv[6]) == 64) {
+      quality_score = 'h';
+   }
+   else {
+      std::cout << std::endl << "ERROR: Quality score offset should be either 33 or 64" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::size_t num_threads = atoi(argv[7]);
+
+   if (num_threads == 0) {
+      num_threads = std::max(1U, std::thread::hardware_concurrency());
+   }
+
+   for (int it = 0; it < 256; it++) {
+      complement_table[it] = (char)it;
+   }
+
+   complement_table[(unsigned char)'A'] = 'T';
+   complement_table[(unsigned char)'C'] = 'G';
+   complement_table[(unsigned char)'G'] = 'C';
+   complement_table[(unsigned char)'T'] = 'A';
+
+   // load reference sequences
+   T_ref_map ref_1;
+   T_ref_map ref_2;
+
+   bool has_ref_2 = (std::string(argv[3]) != "-");
+
+   std::cout << "Reading reference sequences" << std::endl;
+
+   read_ref_sequence(argv[2], ref_1);
+
+   if (has_ref_2 == true) {
+      read_ref_sequence(argv[3], ref_2);
+   }
+
+   std::cout << "     Reading reference sequences: done" << std::endl;
+
+   // open files
+   std::ifstream f_location(argv[1]);
+
+   if (f_location.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[1] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::ofstream f_fastq1(argv[4]);
+
+   if (f_fastq1.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[4] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::ofstream f_fastq2(argv[5]);
+
+   if (f_fastq2.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[5] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::cout << "Writing reads" << std::endl;
+
+   C_read_generator generator(f_location, f_fastq1, f_fastq2, argv[1], ref_1, ref_2, has_ref_2, quality_score, num_threads);
+
+   generator.run();
+
+   f_location.close();
+   f_fastq1.close();
+   f_fastq2.close();
+
+   std::cout << "     Number of threads   : " << num_threads << std::endl;
+   printf("     Number of read pairs: %12zu\n", generator.num_pairs);
+   std::cout << "     Writing reads: done" << std::endl;
+}
+
+
+
+//----------------------------------------------------------------------
+// read_ref_sequence
+// white spaces in sequence names are removed
+// and sequences are converted to upper case
+//----------------------------------------------------------------------
+void read_ref_sequence(const char* ref_file_name, T_ref_map& ref_map) {
+   std::ifstream f_ref(ref_file_name);
+
+   if (f_ref.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << ref_file_name << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::string line;
+   std::string seq_name;
+   std::string buffer;
+
+   bool first_seq = true;
+
+   while (std::getline(f_ref, line)) {
+      // header
+      if ((line.length() > 1) && (line[0] == '>')) {
+         // not the first sequence
+         if (first_seq == false) {
+            if (buffer.empty() == true) {
+               std::cout << std::endl << "ERROR: Buffer is empty" << std::endl << std::endl;
+               exit(EXIT_FAILURE);
+            }
+
+            ref_map[seq_name].swap(buffer);
+         }
+
+         // remove white space in the sequence name
+         seq_name.clear();
+
+         for (std::size_t it = 1; it < line.length(); it++) {
+            if ((line[it] != ' ') && (line[it] != '\t')) {
+               seq_name.push_back(line[it]);
+            }
+         }
+
+         buffer.clear();
+
+         first_seq = false;
+      }
+      // sequence
+      else if (line.empty() == false) {
+         for (std::size_t it = 0; it < line.length(); it++) {
+            buffer.push_back(toupper(line[it]));
+         }
+      }
+   }
+
+   if (buffer.empty() == false) {
+      if (ref_map.count(seq_name) > 0) {
+         std::cout << std::endl << "ERROR: Same sequence name" << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+
+      ref_map[seq_name].swap(buffer);
+   }
+
+   f_ref.close();
+}
+
+
+
+//----------------------------------------------------------------------
+// split_line
+//----------------------------------------------------------------------
+void split_line(const std::string& line, std::vector<std::string>& fields) {
+   fields.clear();
+
+   std::size_t it_begin = 0;
+
+   while (it_begin < line.length()) {
+      std::size_t it_end = it_begin;
+
+      while ((it_end < line.length()) && (isspace(line[it_end]) == false)) {
+         it_end++;
+      }
+
+      fields.push_back(line.substr(it_begin, it_end - it_begin));
+
+      it_begin = it_end;
+
+      while ((it_begin < line.length()) && isspace(line[it_begin])) {
+         it_begin++;
+      }
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// parse_location_line
+// returns false if the line is not a location line with errors
+//----------------------------------------------------------------------
+bool parse_location_line(const std::string& line, C_location_record& record) {
+   if ((line.empty() == true) || isspace(line[0])) {
+      return false;
+   }
+
+   std::vector<std::string> fields;
+
+   split_line(line, fields);
+
+   if (fields.size() < 9) {
+      return false;
+   }
+
+   // ref 1 or 2
+   if ((fields[1] != "1") && (fields[1] != "2")) {
+      return false;
+   }
+
+   // strand
+   if ((fields[3] != "+") && (fields[3] != "-")) {
+      return false;
+   }
+
+   // start index
+   if (fields[4].find_first_not_of("0123456789-") != std::string::npos) {
+      return false;
+   }
+
+   // read length
+   if (fields[5].find_first_not_of("0123456789") != std::string::npos) {
+      return false;
+   }
+
+   record.read_name   = fields[0];
+   record.genome      = fields[1][0];
+   record.seq_name    = fields[2];
+   record.strand      = fields[3][0];
+   record.position    = atol(fields[4].c_str());
+   record.read_length = atol(fields[5].c_str());
+   record.insertions  = fields[7];
+   record.deletions   = fields[8];
+
+   return true;
+}
+
+
+
+//----------------------------------------------------------------------
+// is_na_line
+// <read name> N/A
+//----------------------------------------------------------------------
+bool is_na_line(const std::string& line) {
+   if ((line.empty() == true) || isspace(line[0]) || (line.length() < 3) || (line.compare(line.length() - 3, 3, "N/A") != 0)) {
+      return false;
+   }
+
+   std::vector<std::string> fields;
+
+   split_line(line, fields);
+
+   return ((fields.size() == 2) && (fields[1] == "N/A"));
+}
+
+
+
+//----------------------------------------------------------------------
+// count_insertions
+// <index>:<bases>;
+//----------------------------------------------------------------------
+long count_insertions(const std::string& insertions) {
+   long num_insertions = 0;
+
+   if (insertions == "-") {
+      return num_insertions;
+   }
+
+   std::size_t it = 0;
+
+   while (it < insertions.length()) {
+      if (isdigit(insertions[it]) == false) {
+         it++;
+         continue;
+      }
+
+      std::size_t it_end = it;
+
+      while ((it_end < insertions.length()) && isdigit(insertions[it_end])) {
+         it_end++;
+      }
+
+      if ((it_end >= insertions.length()) || (insertions[it_end] != ':')) {
+         it = it_end;
+         continue;
+      }
+
+      std::size_t it_bases     = it_end + 1;
+      std::size_t it_bases_end = it_bases;
+
+      while ((it_bases_end < insertions.length()) && (std::string("ACGT").find(insertions[it_bases_end]) != std::string::npos)) {
+         it_bases_end++;
+      }
+
+      if ((it_bases_end > it_bases) && (it_bases_end < insertions.length()) && (insertions[it_bases_end] == ';')) {
+         num_insertions += it_bases_end - it_bases;
+         it = it_bases_end + 1;
+      }
+      else {
+         it = it_end;
+      }
+   }
+
+   return num_insertions;
+}
+
+
+
+//----------------------------------------------------------------------
+// count_deletions
+// <index>:<base>;
+//----------------------------------------------------------------------
+long count_deletions(const std::string& deletions) {
+   long num_deletions = 0;
+
+   if (deletions == "-") {
+      return num_deletions;
+   }
+
+   std::size_t it = 0;
+
+   while (it < deletions.length()) {
+      if (isdigit(deletions[it]) == false) {
+         it++;
+         continue;
+      }
+
+      std::size_t it_end = it;
+
+      while ((it_end < deletions.length()) && isdigit(deletions[it_end])) {
+         it_end++;
+      }
+
+      if ((it_end + 2 < deletions.length()) && (deletions[it_end] == ':') && (std::string("ACGT").find(deletions[it_end + 1]) != std::string::npos) && (deletions[it_end + 2] == ';')) {
+         num_deletions++;
+         it = it_end + 3;
+      }
+      else {
+         it = it_end;
+      }
+   }
+
+   return num_deletions;
+}
+
+
+
+//----------------------------------------------------------------------
+// C_read_generator::C_read_generator
+//----------------------------------------------------------------------
+C_read_generator::C_read_generator(std::ifstream& in_f_location, std::ofstream& in_f_fastq1, std::ofstream& in_f_fastq2, const char* in_location_file_name, const T_ref_map& in_ref_1, const T_ref_map& in_ref_2, const bool& in_has_ref_2, const char& in_quality_score, const std::size_t& in_num_threads) :
+   C_ordered_pipeline<C_batch>(in_num_threads),
+   f_location(in_f_location),
+   f_fastq1(in_f_fastq1),
+   f_fastq2(in_f_fastq2),
+   location_file_name(in_location_file_name),
+   ref_1(in_ref_1),
+   ref_2(in_ref_2),
+   has_ref_2(in_has_ref_2),
+   quality_score(in_quality_score),
+   num_pairs_done(0),
+   num_pairs(0) {
+}
+
+
+
+//----------------------------------------------------------------------
+// C_read_generator::read_batch
+// runs in the reader thread
+// a pair is skipped if either of the reads is N/A
+//----------------------------------------------------------------------
+bool C_read_generator::read_batch(C_batch& batch) {
+   std::string line1;
+   std::string line2;
+
+   batch.records.reserve(PAIR_BATCH_SIZE * 2);
+
+   while (batch.records.size() < PAIR_BATCH_SIZE * 2) {
+      if (!std::getline(f_location, line1)) {
+         break;
+      }
+
+      C_location_record record1;
+      C_location_record record2;
+
+      // forward read
+      if (parse_location_line(line1, record1) == true) {
+         // reverse read
+         if (!std::getline(f_location, line2)) {
+            std::cout << std::endl << "ERROR: The number of reads in " << location_file_name << " is not even" << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         if (parse_location_line(line2, record2) == true) {
+            batch.records.push_back(record1);
+            batch.records.push_back(record2);
+
+            num_pairs++;
+         }
+         // first: normal line; second: N/A
+         else if (is_na_line(line2) == false) {
+            std::cout << std::endl << "ERROR: " << line2 << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+      }
+      // first line: N/A
+      // the next line is skipped
+      else if (is_na_line(line1) == true) {
+         std::getline(f_location, line2);
+      }
+      else {
+         std::cout << std::endl << "ERROR: " << line1 << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+   }
+
+   return (batch.records.empty() == false);
+}
+
+
+
+//----------------------------------------------------------------------
+// C_read_generator::process_batch
+// runs in each worker thread
+//----------------------------------------------------------------------
+void C_read_generator::process_batch(C_batch& batch, const std::size_t& thread_id) {
+   for (std::size_t it_record = 0; it_record < batch.records.size(); it_record += 2) {
+      extract_sequence(batch.records[it_record], batch.fastq1);
+      extract_sequence(batch.records[it_record + 1], batch.fastq2);
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// C_read_generator::write_batch
+// runs in the calling thread in the input order
+//----------------------------------------------------------------------
+void C_read_generator::write_batch(C_batch& batch) {
+   f_fastq1 << batch.fastq1;
+   f_fastq2 << batch.fastq2;
+
+   num_pairs_done += batch.records.size() / 2;
+
+   if ((num_pairs_done % PROGRESS_INTERVAL) == 0) {
+      printf("     %12zu lines processed\n", num_pairs_done);
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// C_read_generator::extract_sequence
+// the original sequence of a read is
+// <read length> - <inserted bases> + <deleted bases> bases from <start index> (1-based)
+// reads from the "-" strand are reverse complemented
+//----------------------------------------------------------------------
+void C_read_generator::extract_sequence(const C_location_record& record, std::string& fastq) {
+   const T_ref_map* ref_map;
+
+   if (record.genome == '1') {
+      ref_map = &ref_1;
+   }
+   else {
+      if (has_ref_2 == false) {
+         std::cout << std::endl << "ERROR: The location file has reads coming from Ref 2. Please, use the -ref2 option" << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+
+      ref_map = &ref_2;
+   }
+
+   // unknown reference names give empty reads
+   static const std::string empty_seq;
+
+   T_ref_map::const_iterator it_ref = ref_map->find(record.seq_name);
+
+   const std::string& ref_seq = (it_ref == ref_map->end()) ? empty_seq : it_ref->second;
+
+   long ref_length = ref_seq.length();
+   long seq_length = record.read_length - count_insertions(record.insertions) + count_deletions(record.deletions);
+
+   // the region is clipped by the reference boundaries
+   long seq_begin = record.position - 1;
+
+   if (seq_begin < 0) {
+      seq_begin += ref_length;
+   }
+
+   long seq_end = seq_begin + seq_length;
+
+   seq_begin = std::min(std::max(seq_begin, 0L), ref_length);
+   seq_end   = std::min(seq_end, ref_length);
+
+   if (seq_end < seq_begin) {
+      seq_end = seq_begin;
+   }
+
+   // header
+   fastq += "@";
+   fastq += record.read_name;
+   fastq += "\n";
+
+   // sequence
+   if (record.strand == '+') {
+      fastq.append(ref_seq, seq_begin, seq_end - seq_begin);
+   }
+   else {
+      for (long it_base = seq_end - 1; it_base >= seq_begin; it_base--) {
+         fastq.push_back(complement_table[(unsigned char)ref_seq[it_base]]);
+      }
+   }
+
+   // quality scores
+   fastq += "\n+\n";
+   fastq.append(seq_end - seq_begin, quality_score);
+   fastq += "\n";
+}
@@ -0,0 +1,558 @@
+// CONTACT: yunheo1@illinois.edu
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include "ordered-pipeline.h"
+
+// number of location lines read by the reader thread at a time
+#define LINE_BATCH_SIZE 20000
+
+
+
+//----------------------------------------------------------------------
+// heterozygous snps in a chromosome sorted by their positions
+// positions: 1-based
+// alternatives: positive-strand-based
+//----------------------------------------------------------------------
+struct C_snp_list {
+   std::vector<long>        positions;
+   std::vector<std::string> alternatives;
+};
+
+typedef std::unordered_map<std::string, C_snp_list> T_snp_map;
+
+
+
+//----------------------------------------------------------------------
+// location lines and their filtered lines
+//----------------------------------------------------------------------
+struct C_batch {
+   std::vector<std::string> lines;
+   std::string              location_lines;
+   std::string              removed_lines;
+   std::size_t              num_substitutions;
+   std::size_t              num_substitutions_removed;
+};
+
+
+
+//----------------------------------------------------------------------
+// reader, worker, and writer threads
+// batches are filtered in any order but written in the input order
+//----------------------------------------------------------------------
+class C_heterozygosity_filter : public C_ordered_pipeline<C_batch> {
+   private:
+      std::ifstream& f_location;
+      std::ofstream& f_out;
+      std::ofstream& f_removed;
+
+      const T_snp_map& snp_map;
+
+      // empty: all the chromosomes
+      std::string target_chromosome;
+
+      bool read_batch(C_batch& batch);
+      void process_batch(C_batch& batch, const std::size_t& thread_id);
+      void write_batch(C_batch& batch);
+      void filter_one_line(const std::string& line, C_batch& batch);
+      const std::string* find_snp(const std::string& chromosome, const long& position);
+
+   public:
+      std::size_t total_num_substitutions;
+      std::size_t total_num_substitutions_removed;
+
+      C_heterozygosity_filter(std::ifstream& in_f_location, std::ofstream& in_f_out, std::ofstream& in_f_removed, const T_snp_map& in_snp_map, const std::string& in_target_chromosome, const std::size_t& in_num_threads);
+};
+
+
+
+void read_heterozygosities(const char* vcf_file_name, const std::string& target_chromosome, T_snp_map& snp_map);
+void split_line(const std::string& line, std::vector<std::string>& fields, std::vector<std::size_t>& field_begins, const std::size_t& max_fields);
+bool is_base(const char& base);
+char complement_base(const char& base);
+
+
+
+int main (int argc, char** argv) {
+   // check the number of arguments
+   if (argc != 7) {
+      std::cout << std::endl << "USAGE: " << argv[0] << " <location file> <vcf file> <chromosome|-: all> <output location file> <output removed substitution file> <number of threads|0: all cores>" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::string target_chromosome(argv[3]);
+
+   if (target_chromosome == "-") {
+      target_chromosome.clear();
+   }
+
+   std::size_t num_threads = atoi(argv[6]);
+
+   if (num_threads == 0) {
+      num_threads = std::max(1U, std::thread::hardware_concurrency());
+   }
+
+   // load heterozygosities
+   std::cout << "Reading heterozygosities" << std::endl;
+
+   T_snp_map snp_map;
+
+   read_heterozygosities(argv[2], target_chromosome, snp_map);
+
+   std::size_t num_snps = 0;
+
+   for (T_snp_map::const_iterator it_chr = snp_map.begin(); it_chr != snp_map.end(); it_chr++) {
+      num_snps += it_chr->second.positions.size();
+   }
+
+   printf("     Number of chromosomes: %12zu\n", snp_map.size());
+   printf("     Number of snps       : %12zu\n", num_snps);
+   std::cout << "     Reading heterozygosities: done" << std::endl << std::endl;
+
+   // open files
+   std::ifstream f_location(argv[1]);
+
+   if (f_location.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[1] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::ofstream f_out(argv[4]);
+
+   if (f_out.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[4] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::ofstream f_removed(argv[5]);
+
+   if (f_removed.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[5] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::cout << "Removing heterozygosities" << std::endl;
+
+   C_heterozygosity_filter filter(f_location, f_out, f_removed, snp_map, target_chromosome, num_threads);
+
+   filter.run();
+
+   f_location.close();
+   f_out.close();
+   f_removed.close();
+
+   printf("     Total number of substitutions in the target chromosomes: %12zu\n", filter.total_num_substitutions);
+   printf("     Total number of removed substitutions                  : %12zu\n", filter.total_num_substitutions_removed);
+   std::cout << "     Removing heterozygosities: done" << std::endl;
+}
+
+
+
+//----------------------------------------------------------------------
+// read_heterozygosities
+// <chrom> <pos> <id> <ref> <alt> <qual> <filter> ...
+// only the snps that passed the filters are loaded
+// commas in the alternatives are removed
+// the last line is used when a position appears multiple times
+//----------------------------------------------------------------------
+void read_heterozygosities(const char* vcf_file_name, const std::string& target_chromosome, T_snp_map& snp_map) {
+   std::ifstream f_vcf(vcf_file_name);
+
+   if (f_vcf.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << vcf_file_name << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   // <position, line number> for sorting
+   std::unordered_map<std::string, std::vector<std::pair<long, std::size_t> > > map_order;
+
+   std::string line;
+
+   std::vector<std::string> fields;
+   std::vector<std::size_t> field_begins;
+
+   std::size_t num_lines = 0;
+
+   while (std::getline(f_vcf, line)) {
+      if ((line.empty() == true) || (line[0] == '#') || isspace(line[0])) {
+         continue;
+      }
+
+      split_line(line, fields, field_begins, 7);
+
+      if (fields.size() < 7) {
+         continue;
+      }
+
+      // reference base
+      if ((fields[3].length() != 1) || (is_base(fields[3][0]) == false)) {
+         continue;
+      }
+
+      if ((target_chromosome.empty() == false) && (fields[0] != target_chromosome)) {
+         continue;
+      }
+
+      // snps only
+      bool is_snp = true;
+
+      for (std::size_t it = 1; it < fields[4].length(); it++) {
+         if (is_base(fields[4][it - 1]) && is_base(fields[4][it])) {
+            is_snp = false;
+            break;
+         }
+      }
+
+      if (is_snp == false) {
+         continue;
+      }
+
+      if ((fields[6] != ".") && (fields[6] != "PASS")) {
+         continue;
+      }
+
+      std::string alternatives;
+
+      for (std::size_t it = 0; it < fields[4].length(); it++) {
+         if (fields[4][it] != ',') {
+            alternatives.push_back(fields[4][it]);
+         }
+      }
+
+      C_snp_list& snp_list = snp_map[fields[0]];
+
+      map_order[fields[0]].push_back(std::make_pair(atol(fields[1].c_str()), snp_list.alternatives.size()));
+      snp_list.alternatives.push_back(alternatives);
+
+      num_lines++;
+   }
+
+   f_vcf.close();
+
+   // sort the snps in each chromosome by their positions
+   for (T_snp_map::iterator it_chr = snp_map.begin(); it_chr != snp_map.end(); it_chr++) {
+      std::vector<std::pair<long, std::size_t> >& order = map_order[it_chr->first];
+
+      std::sort(order.begin(), order.end());
+
+      std::vector<long>        positions;
+      std::vector<std::string> alternatives;
+
+      positions.reserve(order.size());
+      alternatives.reserve(order.size());
+
+      for (std::size_t it = 0; it < order.size(); it++) {
+         // the later line overwrites the previous one
+         if ((positions.empty() == false) && (positions.back() == order[it].first)) {
+            alternatives.back().swap(it_chr->second.alternatives[order[it].second]);
+            continue;
+         }
+
+         positions.push_back(order[it].first);
+         alternatives.push_back(std::string());
+         alternatives.back().swap(it_chr->second.alternatives[order[it].second]);
+      }
+
+      it_chr->second.positions.swap(positions);
+      it_chr->second.alternatives.swap(alternatives);
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// split_line
+// at most max_fields fields are extracted
+// field_begins: the start offset of each field in the line
+//----------------------------------------------------------------------
+void split_line(const std::string& line, std::vector<std::string>& fields, std::vector<std::size_t>& field_begins, const std::size_t& max_fields) {
+   fields.clear();
+   field_begins.clear();
+
+   std::size_t it_begin = 0;
+
+   while ((it_begin < line.length()) && (fields.size() < max_fields)) {
+      std::size_t it_end = it_begin;
+
+      while ((it_end < line.length()) && (isspace(line[it_end]) == false)) {
+         it_end++;
+      }
+
+      fields.push_back(line.substr(it_begin, it_end - it_begin));
+      field_begins.push_back(it_begin);
+
+      it_begin = it_end;
+
+      while ((it_begin < line.length()) && isspace(line[it_begin])) {
+         it_begin++;
+      }
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// is_base
+//----------------------------------------------------------------------
+bool is_base(const char& base) {
+   return ((base == 'A') || (base == 'C') || (base == 'G') || (base == 'T'));
+}
+
+
+
+//----------------------------------------------------------------------
+// complement_base
+//----------------------------------------------------------------------
+char complement_base(const char& base) {
+   switch (base) {
+      case 'A':
+         return 'T';
+      case 'C':
+         return 'G';
+      case 'G':
+         return 'C';
+      case 'T':
+         return 'A';
+      default:
+         std::cout << std::endl << "ERROR: Illegal character " << base << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// C_heterozygosity_filter::C_heterozygosity_filter
+//----------------------------------------------------------------------
+C_heterozygosity_filter::C_heterozygosity_filter(std::ifstream& in_f_location, std::ofstream& in_f_out, std::ofstream& in_f_removed, const T_snp_map& in_snp_map, const std::string& in_target_chromosome, const std::size_t& in_num_threads) :
+   C_ordered_pipeline<C_batch>(in_num_threads),
+   f_location(in_f_location),
+   f_out(in_f_out),
+   f_removed(in_f_removed),
+   snp_map(in_snp_map),
+   target_chromosome(in_target_chromosome),
+   total_num_substitutions(0),
+   total_num_substitutions_removed(0) {
+}
+
+
+
+//----------------------------------------------------------------------
+// C_heterozygosity_filter::read_batch
+// runs in the reader thread
+//----------------------------------------------------------------------
+bool C_heterozygosity_filter::read_batch(C_batch& batch) {
+   batch.lines.resize(LINE_BATCH_SIZE);
+
+   std::size_t num_lines = 0;
+
+   while (num_lines < LINE_BATCH_SIZE) {
+      if (!std::getline(f_location, batch.lines[num_lines])) {
+         break;
+      }
+
+      num_lines++;
+   }
+
+   batch.lines.resize(num_lines);
+
+   return (num_lines > 0);
+}
+
+
+
+//----------------------------------------------------------------------
+// C_heterozygosity_filter::process_batch
+// runs in each worker thread
+//----------------------------------------------------------------------
+void C_heterozygosity_filter::process_batch(C_batch& batch, const std::size_t& thread_id) {
+   batch.num_substitutions         = 0;
+   batch.num_substitutions_removed = 0;
+
+   for (std::size_t it_line = 0; it_line < batch.lines.size(); it_line++) {
+      filter_one_line(batch.lines[it_line], batch);
+   }
+
+   batch.lines.clear();
+   batch.lines.shrink_to_fit();
+}
+
+
+
+//----------------------------------------------------------------------
+// C_heterozygosity_filter::write_batch
+// runs in the calling thread in the input order
+//----------------------------------------------------------------------
+void C_heterozygosity_filter::write_batch(C_batch& batch) {
+   f_out     << batch.location_lines;
+   f_removed << batch.removed_lines;
+
+   total_num_substitutions         += batch.num_substitutions;
+   total_num_substitutions_removed += batch.num_substitutions_removed;
+}
+
+
+
+//----------------------------------------------------------------------
+// C_heterozygosity_filter::find_snp
+// binary search in the sorted snp positions of a chromosome
+// returns the alternatives or NULL if there is no snp at the position
+//----------------------------------------------------------------------
+const std::string* C_heterozygosity_filter::find_snp(const std::string& chromosome, const long& position) {
+   T_snp_map::const_iterator it_chr = snp_map.find(chromosome);
+
+   if (it_chr == snp_map.end()) {
+      return NULL;
+   }
+
+   const std::vector<long>& positions = it_chr->second.positions;
+
+   std::vector<long>::const_iterator it_position = std::lower_bound(positions.begin(), positions.end(), position);
+
+   if ((it_position == positions.end()) || (*it_position != position)) {
+      return NULL;
+   }
+
+   return &(it_chr->second.alternatives[it_position - positions.begin()]);
+}
+
+
+
+//----------------------------------------------------------------------
+// C_heterozygosity_filter::filter_one_line
+// <read name> <ref 1 or 2> <ref name> <strand> <start index> <read length> <substitutions> <insertions> <deletions>
+// substitutions at heterozygous snps are moved to the removed substitution file
+//----------------------------------------------------------------------
+void C_heterozygosity_filter::filter_one_line(const std::string& line, C_batch& batch) {
+   std::vector<std::string> fields;
+   std::vector<std::size_t> field_begins;
+
+   if ((line.empty() == false) && (isspace(line[0]) == false)) {
+      split_line(line, fields, field_begins, 9);
+   }
+
+   bool is_location = (fields.size() == 9) &&
+                      ((fields[1] == "1") || (fields[1] == "2")) &&
+                      ((fields[3] == "+") || (fields[3] == "-")) &&
+                      (fields[4].find_first_not_of("0123456789-") == std::string::npos) &&
+                      (fields[5].find_first_not_of("0123456789") == std::string::npos);
+
+   if (is_location == false) {
+      // N/A line
+      if ((fields.size() == 2) && (fields[1] == "N/A") && (line.compare(line.length() - 3, 3, "N/A") == 0)) {
+         batch.location_lines += line;
+         batch.location_lines += "\n";
+         return;
+      }
+
+      std::cout << std::endl << "ERROR: " << line << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   if (fields[1] == "2") {
+      std::cout << std::endl << "ERROR: Simulated reads should not be used" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   // chromosomes that are not targeted or no substitution error
+   if (((target_chromosome.empty() == false) && (fields[2] != target_chromosome)) || (fields[6] == "-")) {
+      batch.location_lines += line;
+      batch.location_lines += "\n";
+      return;
+   }
+
+   const std::string& substitutions = fields[6];
+
+   std::string substitutions_new;
+
+   long start       = atol(fields[4].c_str());
+   long read_length = atol(fields[5].c_str());
+
+   bool removed_written = false;
+
+   // iterate substitution errors
+   // <index>:<ref base>-><err base>;
+   std::size_t it = 0;
+
+   while (it < substitutions.length()) {
+      if (isdigit(substitutions[it]) == false) {
+         it++;
+         continue;
+      }
+
+      std::size_t it_end = it;
+
+      while ((it_end < substitutions.length()) && isdigit(substitutions[it_end])) {
+         it_end++;
+      }
+
+      if (!((it_end + 5 < substitutions.length()) && (substitutions[it_end] == ':') && is_base(substitutions[it_end + 1]) && (substitutions[it_end + 2] == '-') && (substitutions[it_end + 3] == '>') && is_base(substitutions[it_end + 4]) && (substitutions[it_end + 5] == ';'))) {
+         it = it_end;
+         continue;
+      }
+
+      std::string error(substitutions, it, it_end + 6 - it);
+
+      long position = atol(substitutions.c_str() + it);
+      char err_base = substitutions[it_end + 4];
+
+      long position_converted;
+      char err_base_pos_strand;
+
+      if (fields[3] == "+") {
+         position_converted  = start + position - 1;
+         err_base_pos_strand = err_base;
+      }
+      else {
+         position_converted = start + read_length - position;
+
+         // always positive strand
+         err_base_pos_strand = complement_base(err_base);
+      }
+
+      const std::string* alternatives = find_snp(fields[2], position_converted);
+
+      if ((alternatives != NULL) && (alternatives->find(err_base_pos_strand) != std::string::npos)) {
+         if (removed_written == false) {
+            batch.removed_lines += fields[0];
+            batch.removed_lines += " ";
+            removed_written = true;
+         }
+
+         batch.removed_lines += error;
+
+         batch.num_substitutions_removed++;
+      }
+      else {
+         substitutions_new += error;
+      }
+
+      batch.num_substitutions++;
+
+      it = it_end + 6;
+   }
+
+   if (removed_written == true) {
+      batch.removed_lines += "\n";
+   }
+
+   // all the substitutions are removed
+   if (substitutions_new.empty() == true) {
+      substitutions_new = "-";
+   }
+
+   // insertions and deletions are copied with the white spaces between them
+   std::size_t it_remaining_end = field_begins[8] + fields[8].length();
+
+   batch.location_lines += fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3] + " " + fields[4] + " " + fields[5] + " " + substitutions_new + " ";
+   batch.location_lines.append(line, field_begins[7], it_remaining_end - field_begins[7]);
+   batch.location_lines += "\n";
+}
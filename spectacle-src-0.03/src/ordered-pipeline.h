@@ -0,0 +1,195 @@
+// CONTACT: yunheo1@illinois.edu
+
+#ifndef ORDERED_PIPELINE_H
+#define ORDERED_PIPELINE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// maximum number of batches waiting to be processed per worker thread
+#define MAX_QUEUED_BATCHES 4
+
+
+
+//----------------------------------------------------------------------
+// C_ordered_pipeline
+// a reader thread, worker threads, and the calling thread as the writer
+// batches are processed in any order but written in the input order
+//
+// read_batch   : runs in the reader thread
+//                fills an empty batch and returns false if nothing is left to read
+// process_batch: runs in each worker thread
+//                thread_id is in [0, num_threads)
+// write_batch  : runs in the calling thread
+//----------------------------------------------------------------------
+template <class T_batch>
+class C_ordered_pipeline {
+   private:
+      // batches to be processed
+      std::deque<std::pair<std::size_t, T_batch*> > input_queue;
+      bool                                          reader_done;
+
+      // processed batches that are not written yet
+      std::map<std::size_t, T_batch*> output_queue;
+      std::size_t                     num_batches;
+
+      std::mutex              queue_mutex;
+      std::condition_variable input_cond;
+      std::condition_variable output_cond;
+
+      void read_batches();
+      void process_batches(const std::size_t thread_id);
+
+   protected:
+      std::size_t num_threads;
+
+      virtual bool read_batch(T_batch& batch) = 0;
+      virtual void process_batch(T_batch& batch, const std::size_t& thread_id) = 0;
+      virtual void write_batch(T_batch& batch) = 0;
+
+   public:
+      C_ordered_pipeline(const std::size_t& in_num_threads) :
+         reader_done(false),
+         num_batches(0),
+         num_threads(in_num_threads) {
+      }
+
+      virtual ~C_ordered_pipeline() {
+      }
+
+      void run();
+};
+
+
+
+//----------------------------------------------------------------------
+// C_ordered_pipeline::run
+// the calling thread writes the processed batches in the input order
+//----------------------------------------------------------------------
+template <class T_batch>
+void C_ordered_pipeline<T_batch>::run() {
+   std::thread reader(&C_ordered_pipeline::read_batches, this);
+
+   std::vector<std::thread> workers;
+
+   for (std::size_t it_thread = 0; it_thread < num_threads; it_thread++) {
+      workers.push_back(std::thread(&C_ordered_pipeline::process_batches, this, it_thread));
+   }
+
+   std::size_t next_batch_id = 0;
+
+   while (true) {
+      T_batch* batch;
+
+      {
+         std::unique_lock<std::mutex> lock(queue_mutex);
+
+         while ((output_queue.count(next_batch_id) == 0) && ((reader_done == false) || (next_batch_id < num_batches))) {
+            output_cond.wait(lock);
+         }
+
+         if (output_queue.count(next_batch_id) == 0) {
+            break;
+         }
+
+         batch = output_queue[next_batch_id];
+         output_queue.erase(next_batch_id);
+      }
+
+      write_batch(*batch);
+
+      delete batch;
+
+      next_batch_id++;
+   }
+
+   reader.join();
+
+   for (std::size_t it_thread = 0; it_thread < num_threads; it_thread++) {
+      workers[it_thread].join();
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// C_ordered_pipeline::read_batches
+// runs in the reader thread
+//----------------------------------------------------------------------
+template <class T_batch>
+void C_ordered_pipeline<T_batch>::read_batches() {
+   bool eof = false;
+
+   while (eof == false) {
+      T_batch* batch = new T_batch;
+
+      eof = (read_batch(*batch) == false);
+
+      std::unique_lock<std::mutex> lock(queue_mutex);
+
+      if (eof == false) {
+         while (input_queue.size() >= MAX_QUEUED_BATCHES * num_threads) {
+            input_cond.wait(lock);
+         }
+
+         input_queue.push_back(std::make_pair(num_batches, batch));
+         num_batches++;
+      }
+      else {
+         delete batch;
+
+         reader_done = true;
+         output_cond.notify_all();
+      }
+
+      input_cond.notify_all();
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// C_ordered_pipeline::process_batches
+// runs in each worker thread
+//----------------------------------------------------------------------
+template <class T_batch>
+void C_ordered_pipeline<T_batch>::process_batches(const std::size_t thread_id) {
+   while (true) {
+      std::pair<std::size_t, T_batch*> batch;
+
+      {
+         std::unique_lock<std::mutex> lock(queue_mutex);
+
+         while ((input_queue.empty() == true) && (reader_done == false)) {
+            input_cond.wait(lock);
+         }
+
+         if (input_queue.empty() == true) {
+            return;
+         }
+
+         batch = input_queue.front();
+         input_queue.pop_front();
+
+         input_cond.notify_all();
+      }
+
+      process_batch(*batch.second, thread_id);
+
+      {
+         std::unique_lock<std::mutex> lock(queue_mutex);
+
+         output_queue[batch.first] = batch.second;
+
+         output_cond.notify_all();
+      }
+   }
+}
+
+#endif
@@ -0,0 +1,656 @@
+// CONTACT: yunheo1@illinois.edu
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <queue>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
+#include <cctype>
+#include <stdint.h>
+#include <htslib/sam.h>
+#include <htslib/faidx.h>
+
+// same as the default values of samtools mpileup
+#define MAX_PILEUP_DEPTH 250
+#define READ_FILTER      (BAM_FUNMAP | BAM_FSECONDARY | BAM_FQCFAIL | BAM_FDUP)
+
+// <chr index (4 bytes)> <error index (4 bytes)> <org base> <err base> <Y|N>
+// <start index (4 bytes)> <end index (4 bytes)>
+// the last two identify the reference window of the read and are not used here
+#define RECORD_SIZE      19
+
+// runs are read in buffered chunks through a small pool of file handles
+// so that the number of open files does not grow with the number of runs
+#define MAX_OPEN_FILES    64
+#define MERGE_BUFFER_SIZE 268435456
+#define MIN_CHUNK_RECORDS 64
+
+
+
+//----------------------------------------------------------------------
+// one error index record
+//----------------------------------------------------------------------
+struct C_error {
+   std::size_t chr_index;
+   std::size_t err_index;
+   char        err_base;
+   bool        corrected;
+};
+
+
+
+//----------------------------------------------------------------------
+// at most MAX_OPEN_FILES error index files are open at the same time
+// the least recently used one is closed when another one is needed
+//----------------------------------------------------------------------
+class C_file_pool {
+   private:
+      std::vector<std::string>    file_names;
+      std::vector<std::ifstream*> files;
+      std::vector<uint64_t>       last_used;
+
+      std::size_t num_open_files;
+      uint64_t    num_requests;
+
+   public:
+      C_file_pool() : num_open_files(0), num_requests(0) {};
+      ~C_file_pool();
+
+      std::size_t    add_file(const std::string& file_name);
+      std::ifstream& get_file(const std::size_t& file_id);
+};
+
+
+
+//----------------------------------------------------------------------
+// one sorted run in an error index file
+// evaluate.dna writes each run as
+// <number of records (4 bytes)> <record> <record> ...
+// integers are big-endian
+//----------------------------------------------------------------------
+class C_run_reader {
+   private:
+      std::size_t    file_id;
+      std::streampos next_offset;
+      uint32_t       num_unbuffered_records;
+
+      std::vector<unsigned char> buffer;
+      std::size_t                buffer_pos;
+
+      void fill_buffer(C_file_pool& file_pool, const std::size_t& chunk_records);
+
+   public:
+      C_run_reader(const std::size_t& in_file_id, const std::streampos& offset, const uint32_t& num_records) :
+         file_id(in_file_id),
+         next_offset(offset),
+         num_unbuffered_records(num_records),
+         buffer_pos(0) {};
+
+      bool read_record(C_error& error, C_file_pool& file_pool, const std::size_t& chunk_records);
+};
+
+
+
+//----------------------------------------------------------------------
+// k-way merge of all the runs in the error index files
+//----------------------------------------------------------------------
+class C_error_merger {
+   private:
+      typedef std::pair<uint64_t, std::size_t> type_heap_item;
+
+      C_file_pool                file_pool;
+      std::vector<C_run_reader*> runs;
+      std::vector<C_error>       run_heads;
+
+      // number of records read from a run at a time
+      std::size_t chunk_records;
+      bool        started;
+
+      // <chr index, error index> of the head of each run, run id
+      std::priority_queue<type_heap_item, std::vector<type_heap_item>, std::greater<type_heap_item> > heap;
+
+      void push_run_head(const std::size_t& run_id);
+
+   public:
+      C_error_merger() : chunk_records(MIN_CHUNK_RECORDS), started(false) {};
+      ~C_error_merger();
+
+      void add_file(const std::string& file_name);
+      bool next(C_error& error);
+};
+
+
+
+//----------------------------------------------------------------------
+// histograms that are printed by evaluate.dna
+//----------------------------------------------------------------------
+struct C_histograms {
+   std::vector<std::size_t> num_diff_err_cor;
+   std::vector<std::size_t> num_diff_err_cor_corrected;
+   std::vector<std::size_t> num_diff_err_cor_neg;
+   std::vector<std::size_t> num_diff_err_cor_corrected_neg;
+   std::vector<std::size_t> coverage;
+   std::vector<std::size_t> coverage_corrected;
+
+   std::size_t max_depth;
+
+   C_histograms(const std::size_t& in_max_depth) :
+      num_diff_err_cor(in_max_depth + 1, 0),
+      num_diff_err_cor_corrected(in_max_depth + 1, 0),
+      num_diff_err_cor_neg(in_max_depth + 1, 0),
+      num_diff_err_cor_corrected_neg(in_max_depth + 1, 0),
+      coverage(in_max_depth + 1, 0),
+      coverage_corrected(in_max_depth + 1, 0),
+      max_depth(in_max_depth) {};
+
+   void update(const C_error& error, const std::size_t& num_org_base, const std::size_t& num_err_base);
+};
+
+
+
+//----------------------------------------------------------------------
+// data passed to read_alignment
+//----------------------------------------------------------------------
+struct C_bam_reader {
+   htsFile*   fp;
+   hts_itr_t* itr;
+};
+
+
+
+int read_alignment(void* data, bam1_t* b);
+uint32_t decode_uint32(const unsigned char* buffer);
+
+
+
+int main (int argc, char** argv) {
+   // check the number of arguments
+   if (argc < 6) {
+      std::cout << std::endl << "USAGE: " << argv[0] << " <bam file> <reference fasta> <max depth> <output file> <error index file 1> [error index file 2] ..." << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::size_t max_depth = std::strtoul(argv[3], NULL, 10);
+
+   if (max_depth == 0) {
+      std::cout << std::endl << "ERROR: Max depth should be > 0" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   // open the bam file and its index
+   htsFile* f_bam = hts_open(argv[1], "r");
+
+   if (f_bam == NULL) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[1] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   bam_hdr_t* bam_header = sam_hdr_read(f_bam);
+
+   if (bam_header == NULL) {
+      std::cout << std::endl << "ERROR: Cannot read the header of " << argv[1] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   hts_idx_t* bam_index = sam_index_load(f_bam, argv[1]);
+
+   if (bam_index == NULL) {
+      std::cout << std::endl << "ERROR: Cannot open the index of " << argv[1] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   // open the reference sequence
+   // the index is built if it does not exist
+   faidx_t* ref_index = fai_load(argv[2]);
+
+   if (ref_index == NULL) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[2] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   // open the error index files
+   // records come out sorted by the chromosome index and then by the error index
+   C_error_merger error_merger;
+
+   for (int it_file = 5; it_file < argc; it_file++) {
+      error_merger.add_file(argv[it_file]);
+   }
+
+   C_histograms histograms(max_depth);
+
+   C_error error;
+   bool    error_available = error_merger.next(error);
+
+   // iterate chromosomes
+   while (error_available == true) {
+      std::size_t chr_index = error.chr_index;
+
+      // chromosome indexes are 1-based and follow the order in the reference fasta
+      if ((chr_index < 1) || ((int)chr_index > faidx_nseq(ref_index))) {
+         std::cout << std::endl << "ERROR: Illegal chromosome index " << chr_index << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+
+      const char* chr_name = faidx_iseq(ref_index, chr_index - 1);
+
+      // load the chromosome
+      int   chr_length;
+      char* chr_seq = faidx_fetch_seq(ref_index, chr_name, 0, faidx_seq_len(ref_index, chr_name) - 1, &chr_length);
+
+      if (chr_seq == NULL) {
+         std::cout << std::endl << "ERROR: Cannot read " << chr_name << " from " << argv[2] << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+
+      // walk the bam file from the first error to the end of the chromosome
+      int tid = bam_name2id(bam_header, chr_name);
+
+      C_bam_reader reader;
+      reader.fp  = f_bam;
+      reader.itr = NULL;
+
+      bam_plp_t pileup = NULL;
+
+      if (tid >= 0) {
+         reader.itr = sam_itr_queryi(bam_index, tid, error.err_index - 1, chr_length);
+
+         if (reader.itr == NULL) {
+            std::cout << std::endl << "ERROR: Cannot query " << chr_name << " in " << argv[1] << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         pileup = bam_plp_init(read_alignment, &reader);
+         bam_plp_set_maxcnt(pileup, MAX_PILEUP_DEPTH);
+      }
+
+      int pileup_tid;
+      int pileup_pos = -1;
+      int pileup_num = 0;
+      const bam_pileup1_t* pileup_entries = NULL;
+
+      // the pileup is exhausted
+      bool pileup_done = (pileup == NULL);
+
+      while ((error_available == true) && (error.chr_index == chr_index)) {
+         if ((error.err_index < 1) || ((int)error.err_index > chr_length)) {
+            std::cout << std::endl << "ERROR: " << chr_name << " does not have the " << error.err_index << " th base" << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         // 0-based
+         int err_pos = error.err_index - 1;
+
+         // move the pileup to the current error
+         while ((pileup_done == false) && (pileup_pos < err_pos)) {
+            pileup_entries = bam_plp_auto(pileup, &pileup_tid, &pileup_pos, &pileup_num);
+
+            if ((pileup_entries == NULL) || (pileup_tid != tid)) {
+               pileup_done = true;
+            }
+         }
+
+         std::size_t num_org_base = 0;
+         std::size_t num_err_base = 0;
+
+         // positions without any alignment are not in the pileup
+         if ((pileup_done == false) && (pileup_pos == err_pos)) {
+            char ref_base = toupper(chr_seq[err_pos]);
+
+            for (int it_entry = 0; it_entry < pileup_num; it_entry++) {
+               const bam_pileup1_t* entry = pileup_entries + it_entry;
+
+               if (entry->is_del || entry->is_refskip) {
+                  continue;
+               }
+
+               char base = seq_nt16_str[bam_seqi(bam_get_seq(entry->b), entry->qpos)];
+
+               if ((base == ref_base) || (base == '=')) {
+                  num_org_base++;
+               }
+               else if (base == error.err_base) {
+                  num_err_base++;
+               }
+            }
+         }
+
+         histograms.update(error, num_org_base, num_err_base);
+
+         error_available = error_merger.next(error);
+      }
+
+      if (pileup != NULL) {
+         // alignments that are still in the pileup should be released
+         bam_plp_reset(pileup);
+         bam_plp_destroy(pileup);
+         hts_itr_destroy(reader.itr);
+      }
+
+      free(chr_seq);
+   }
+
+   fai_destroy(ref_index);
+   hts_idx_destroy(bam_index);
+   bam_hdr_destroy(bam_header);
+   hts_close(f_bam);
+
+   // write the histograms
+   // <depth> <diff> <diff corrected> <negative diff> <negative diff corrected> <coverage> <coverage corrected>
+   std::ofstream f_out;
+   f_out.open(argv[4]);
+
+   if (f_out.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[4] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   for (std::size_t it_depth = 0; it_depth <= max_depth; it_depth++) {
+      f_out << it_depth << " "
+            << histograms.num_diff_err_cor[it_depth] << " "
+            << histograms.num_diff_err_cor_corrected[it_depth] << " "
+            << histograms.num_diff_err_cor_neg[it_depth] << " "
+            << histograms.num_diff_err_cor_corrected_neg[it_depth] << " "
+            << histograms.coverage[it_depth] << " "
+            << histograms.coverage_corrected[it_depth] << std::endl;
+   }
+
+   f_out.close();
+}
+
+
+
+//----------------------------------------------------------------------
+// read_alignment
+// filter alignments in the same way as samtools mpileup
+//----------------------------------------------------------------------
+int read_alignment(void* data, bam1_t* b) {
+   C_bam_reader* reader = (C_bam_reader*)data;
+
+   int return_value;
+
+   while (true) {
+      return_value = sam_itr_next(reader->fp, reader->itr, b);
+
+      if (return_value < 0) {
+         break;
+      }
+
+      if (b->core.flag & READ_FILTER) {
+         continue;
+      }
+
+      // orphan reads
+      if ((b->core.flag & BAM_FPAIRED) && !(b->core.flag & BAM_FPROPER_PAIR)) {
+         continue;
+      }
+
+      break;
+   }
+
+   return return_value;
+}
+
+
+
+//----------------------------------------------------------------------
+// C_histograms::update
+//----------------------------------------------------------------------
+void C_histograms::update(const C_error& error, const std::size_t& num_org_base, const std::size_t& num_err_base) {
+   // difference
+   if (num_org_base >= num_err_base) {
+      std::size_t num_diff = num_org_base - num_err_base;
+
+      if (num_diff >= max_depth) {
+         num_diff = max_depth;
+      }
+
+      num_diff_err_cor[num_diff]++;
+
+      if (error.corrected == true) {
+         num_diff_err_cor_corrected[num_diff]++;
+      }
+   }
+   else {
+      std::size_t num_diff = num_err_base - num_org_base;
+
+      if (num_diff >= max_depth) {
+         num_diff = max_depth;
+      }
+
+      num_diff_err_cor_neg[num_diff]++;
+
+      if (error.corrected == true) {
+         num_diff_err_cor_corrected_neg[num_diff]++;
+      }
+   }
+
+   // coverage
+   std::size_t depth = num_org_base;
+
+   if (depth >= max_depth) {
+      depth = max_depth;
+   }
+
+   coverage[depth]++;
+
+   if (error.corrected == true) {
+      coverage_corrected[depth]++;
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// decode_uint32
+//----------------------------------------------------------------------
+uint32_t decode_uint32(const unsigned char* buffer) {
+   return ((uint32_t)buffer[0] << 24) | ((uint32_t)buffer[1] << 16) | ((uint32_t)buffer[2] << 8) | (uint32_t)buffer[3];
+}
+
+
+
+//----------------------------------------------------------------------
+// C_file_pool::~C_file_pool
+//----------------------------------------------------------------------
+C_file_pool::~C_file_pool() {
+   for (std::size_t it_file = 0; it_file < files.size(); it_file++) {
+      delete files[it_file];
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// C_file_pool::add_file
+//----------------------------------------------------------------------
+std::size_t C_file_pool::add_file(const std::string& file_name) {
+   file_names.push_back(file_name);
+   files.push_back(NULL);
+   last_used.push_back(0);
+
+   return file_names.size() - 1;
+}
+
+
+
+//----------------------------------------------------------------------
+// C_file_pool::get_file
+//----------------------------------------------------------------------
+std::ifstream& C_file_pool::get_file(const std::size_t& file_id) {
+   num_requests++;
+   last_used[file_id] = num_requests;
+
+   if (files[file_id] != NULL) {
+      return *files[file_id];
+   }
+
+   // close the least recently used file
+   if (num_open_files >= MAX_OPEN_FILES) {
+      std::size_t lru_id = files.size();
+
+      for (std::size_t it_file = 0; it_file < files.size(); it_file++) {
+         if ((files[it_file] != NULL) && ((lru_id == files.size()) || (last_used[it_file] < last_used[lru_id]))) {
+            lru_id = it_file;
+         }
+      }
+
+      delete files[lru_id];
+      files[lru_id] = NULL;
+      num_open_files--;
+   }
+
+   files[file_id] = new std::ifstream(file_names[file_id].c_str(), std::ios::binary);
+
+   if (files[file_id]->is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << file_names[file_id] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   num_open_files++;
+
+   return *files[file_id];
+}
+
+
+
+//----------------------------------------------------------------------
+// C_run_reader::fill_buffer
+//----------------------------------------------------------------------
+void C_run_reader::fill_buffer(C_file_pool& file_pool, const std::size_t& chunk_records) {
+   std::size_t num_records = std::min((std::size_t)num_unbuffered_records, chunk_records);
+
+   buffer.resize(num_records * RECORD_SIZE);
+   buffer_pos = 0;
+
+   std::ifstream& f_in = file_pool.get_file(file_id);
+
+   f_in.clear();
+   f_in.seekg(next_offset);
+
+   if (!f_in.read((char*)&buffer[0], buffer.size())) {
+      std::cout << std::endl << "ERROR: Truncated error index run" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   next_offset            += (std::streamoff)buffer.size();
+   num_unbuffered_records -= num_records;
+}
+
+
+
+//----------------------------------------------------------------------
+// C_run_reader::read_record
+//----------------------------------------------------------------------
+bool C_run_reader::read_record(C_error& error, C_file_pool& file_pool, const std::size_t& chunk_records) {
+   if (buffer_pos >= buffer.size()) {
+      if (num_unbuffered_records == 0) {
+         // release the memory of finished runs
+         std::vector<unsigned char>().swap(buffer);
+         buffer_pos = 0;
+
+         return false;
+      }
+
+      fill_buffer(file_pool, chunk_records);
+   }
+
+   const unsigned char* record = &buffer[buffer_pos];
+   buffer_pos += RECORD_SIZE;
+
+   error.chr_index = decode_uint32(record);
+   error.err_index = decode_uint32(record + 4);
+   error.err_base  = toupper(record[9]);
+   error.corrected = (record[10] == 'Y');
+
+   return true;
+}
+
+
+
+//----------------------------------------------------------------------
+// C_error_merger::~C_error_merger
+//----------------------------------------------------------------------
+C_error_merger::~C_error_merger() {
+   for (std::size_t it_run = 0; it_run < runs.size(); it_run++) {
+      delete runs[it_run];
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// C_error_merger::add_file
+//----------------------------------------------------------------------
+void C_error_merger::add_file(const std::string& file_name) {
+   std::ifstream f_in;
+   f_in.open(file_name.c_str(), std::ios::binary);
+
+   if (f_in.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << file_name << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   std::size_t file_id = file_pool.add_file(file_name);
+
+   // find the runs in the file
+   // they are read when the merge starts
+   unsigned char buffer[4];
+
+   while (f_in.read((char*)buffer, 4)) {
+      uint32_t num_records = decode_uint32(buffer);
+
+      runs.push_back(new C_run_reader(file_id, f_in.tellg(), num_records));
+      run_heads.push_back(C_error());
+
+      f_in.seekg((std::streamoff)num_records * RECORD_SIZE, std::ios::cur);
+   }
+
+   f_in.close();
+}
+
+
+
+//----------------------------------------------------------------------
+// C_error_merger::push_run_head
+//----------------------------------------------------------------------
+void C_error_merger::push_run_head(const std::size_t& run_id) {
+   if (runs[run_id]->read_record(run_heads[run_id], file_pool, chunk_records) == true) {
+      heap.push(type_heap_item(((uint64_t)run_heads[run_id].chr_index << 32) | run_heads[run_id].err_index, run_id));
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// C_error_merger::next
+//----------------------------------------------------------------------
+bool C_error_merger::next(C_error& error) {
+   // split the buffer memory among the runs and load the head of each run
+   if (started == false) {
+      started = true;
+
+      if (runs.empty() == false) {
+         chunk_records = std::max((std::size_t)MIN_CHUNK_RECORDS, (std::size_t)MERGE_BUFFER_SIZE / RECORD_SIZE / runs.size());
+      }
+
+      for (std::size_t it_run = 0; it_run < runs.size(); it_run++) {
+         push_run_head(it_run);
+      }
+   }
+
+   if (heap.empty() == true) {
+      return false;
+   }
+
+   std::size_t run_id = heap.top().second;
+   heap.pop();
+
+   error = run_heads[run_id];
+
+   push_run_head(run_id);
+
+   return true;
+}
@@ -0,0 +1,103 @@
+// CONTACT: yunheo1@illinois.edu
+
+#ifndef READ_FILE_H
+#define READ_FILE_H
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+
+
+//----------------------------------------------------------------------
+// C_read_file
+// fasta: 2 lines per read
+// fastq: 4 lines per read
+// a header without > or @ and a read cut in the middle are errors
+//----------------------------------------------------------------------
+class C_read_file {
+   private:
+      std::ifstream f_read;
+
+      std::string file_name;
+
+      bool is_fastq;
+      char header_char;
+
+   public:
+      std::string line_header;
+      std::string line_sequence;
+      std::string line_plus;
+      std::string line_quality;
+
+      C_read_file(const std::string& in_file_name, const bool& in_is_fastq);
+
+      bool next_read();
+      bool is_eof();
+
+      const std::string& get_file_name() const {
+         return file_name;
+      }
+};
+
+
+
+//----------------------------------------------------------------------
+// C_read_file::C_read_file
+//----------------------------------------------------------------------
+inline C_read_file::C_read_file(const std::string& in_file_name, const bool& in_is_fastq) :
+   file_name(in_file_name),
+   is_fastq(in_is_fastq) {
+   header_char = (is_fastq == true) ? '@' : '>';
+
+   f_read.open(file_name.c_str());
+
+   if (f_read.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << file_name << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// C_read_file::next_read
+// returns false if there is no more read
+//----------------------------------------------------------------------
+inline bool C_read_file::next_read() {
+   if (!std::getline(f_read, line_header)) {
+      return false;
+   }
+
+   if ((line_header.empty() == true) || (line_header[0] != header_char)) {
+      std::cout << std::endl << "ERROR: Wrong header " << line_header << " in " << file_name << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   bool complete = (bool)std::getline(f_read, line_sequence);
+
+   if ((complete == true) && (is_fastq == true)) {
+      complete = std::getline(f_read, line_plus) && std::getline(f_read, line_quality);
+   }
+
+   if (complete == false) {
+      std::cout << std::endl << "ERROR: " << file_name << " is truncated after " << line_header << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   return true;
+}
+
+
+
+//----------------------------------------------------------------------
+// C_read_file::is_eof
+//----------------------------------------------------------------------
+inline bool C_read_file::is_eof() {
+   std::string line_check;
+
+   return (!std::getline(f_read, line_check));
+}
+
+#endif
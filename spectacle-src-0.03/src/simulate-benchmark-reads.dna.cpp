@@ -0,0 +1,857 @@
+// CONTACT: yunheo1@illinois.edu
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// bases in a line of the reference fasta files
+#define FASTA_LINE_WIDTH 60
+
+// repeats inserted into the genome
+#define MIN_HOMOPOLYMER_LENGTH  5
+#define MAX_HOMOPOLYMER_LENGTH  15
+#define MIN_REPEAT_UNIT_LENGTH  2
+#define MAX_REPEAT_UNIT_LENGTH  6
+#define MIN_NUM_REPEAT_UNITS    3
+#define MAX_NUM_REPEAT_UNITS    8
+#define MIN_DUPLICATION_LENGTH  200
+#define MAX_DUPLICATION_LENGTH  2000
+#define DUPLICATION_DIVERGENCE  0.01
+
+// maximum length of an inserted sequence
+#define MAX_INSERTION_LENGTH 3
+
+// fragment length of paired reads = read length * ratio
+#define INSERT_SIZE_RATIO    3.0
+#define INSERT_SIZE_SD_RATIO 0.1
+
+// length of long reads: [read length * min ratio, read length * max ratio]
+#define MIN_LONG_READ_RATIO 0.5
+#define MAX_LONG_READ_RATIO 1.5
+
+// maximum number of trimmed bases = read length * ratio
+#define MAX_TRIM_RATIO 0.1
+
+// corrected reads are shuffled in blocks of this size
+// so that they should be reordered like the output of a real corrector
+#define CORRECTED_BLOCK_SIZE 10000
+
+// quality score of all the bases
+#define QUALITY_CHAR 'I'
+
+
+
+//----------------------------------------------------------------------
+// simulation parameters
+//----------------------------------------------------------------------
+struct C_parameters {
+   std::string prefix;
+
+   std::size_t num_reads;
+   int         read_length;
+   long        genome_length;
+   int         num_chromosomes;
+
+   // probability that a heterozygous snp is made at a genome base
+   double heterozygosity_rate;
+
+   // probability that a repeat starts at a genome base
+   double repeat_rate;
+
+   // errors in original reads (per reference base)
+   double substitution_rate;
+   double insertion_rate;
+   double deletion_rate;
+
+   // corrector behavior
+   // fixed_rate    : probability that an error is corrected (the others are unchanged)
+   // new_error_rate: probability that a new substitution is made at an error-free base
+   // trim_rate     : probability that the 3' end of a read is trimmed
+   double fixed_rate;
+   double new_error_rate;
+   double trim_rate;
+
+   unsigned long long seed;
+
+   bool is_pacbio;
+};
+
+
+
+//----------------------------------------------------------------------
+// diploid genome
+// genome 2 is made by adding heterozygous snps to genome 1
+//----------------------------------------------------------------------
+struct C_genome {
+   std::vector<std::string> names;
+   std::vector<std::string> chromosomes1;
+   std::vector<std::string> chromosomes2;
+};
+
+
+
+//----------------------------------------------------------------------
+// simulated read
+// location errors: 1-based, reference-window-based, <index>:<error>;
+// info errors    : 1-based, read-based, <index>,<error>; (pirs format)
+// the cigar string is the alignment of the corrected read
+//----------------------------------------------------------------------
+struct C_simulated_read {
+   std::string name;
+   std::string chromosome;
+   std::string original_read;
+   std::string corrected_read;
+
+   std::string location_substitutions;
+   std::string location_insertions;
+   std::string location_deletions;
+
+   std::string info_substitutions;
+   std::string info_insertions;
+   std::string info_deletions;
+
+   std::string cigar;
+
+   int  genome_1_or_2;
+   char strand;
+
+   // 1-based start index of the reference window in the + strand
+   long start_index;
+   long info_start_index;
+
+   // 1-based leftmost position of the aligned corrected read
+   long sam_position;
+};
+
+
+
+//----------------------------------------------------------------------
+// output files
+//----------------------------------------------------------------------
+struct C_output_files {
+   std::ofstream f_fastq1;
+   std::ofstream f_fastq2;
+   std::ofstream f_corrected1;
+   std::ofstream f_corrected2;
+   std::ofstream f_info;
+   std::ofstream f_location;
+   std::ofstream f_sam1;
+   std::ofstream f_sam2;
+
+   // corrected reads waiting to be shuffled
+   std::vector<std::string> corrected_block1;
+   std::vector<std::string> corrected_block2;
+};
+
+
+
+void open_output_file(const std::string& file_name, std::ofstream& f_out);
+void generate_genome(std::mt19937_64& generator, const C_parameters& parameters, C_genome& genome);
+void generate_chromosome(std::mt19937_64& generator, const C_parameters& parameters, const long& length, std::string& chromosome);
+void write_genome(const std::string& file_name, const std::vector<std::string>& names, const std::vector<std::string>& chromosomes);
+void write_sam_header(std::ofstream& f_sam, const C_genome& genome);
+void simulate_reads(std::mt19937_64& generator, const C_parameters& parameters, const C_genome& genome, C_output_files& output_files);
+void simulate_read(std::mt19937_64& generator, const C_parameters& parameters, const std::string& chromosome, const long& anchor, const int& length, C_simulated_read& read);
+void write_read(const C_simulated_read& read, std::ofstream& f_fastq, std::ofstream& f_sam, std::vector<std::string>& corrected_block);
+void write_info_line(const C_simulated_read& read, const int& insert_size, std::ofstream& f_info);
+void write_location_line(const C_simulated_read& read, std::ofstream& f_location);
+void flush_corrected_block(std::mt19937_64& generator, std::vector<std::string>& corrected_block, std::ofstream& f_corrected);
+void reverse_complement(std::string& sequence);
+char random_base(std::mt19937_64& generator);
+char random_other_base(std::mt19937_64& generator, const char& base);
+
+
+
+int main (int argc, char** argv) {
+   // check the number of arguments
+   if (argc != 16) {
+      std::cout << std::endl << "USAGE: " << argv[0] << " <output prefix> <illumina|pacbio> <number of reads (pairs for illumina)> <read length> <genome length> <number of chromosomes> <heterozygosity rate> <repeat rate> <substitution rate> <insertion rate> <deletion rate> <fixed rate> <new error rate> <trim rate> <seed|0>" << std::endl << std::endl;
+      std::cout << "     seed 0: a random seed" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   C_parameters parameters;
+
+   parameters.prefix              = argv[1];
+   parameters.num_reads           = atoll(argv[3]);
+   parameters.read_length         = atoi(argv[4]);
+   parameters.genome_length       = atol(argv[5]);
+   parameters.num_chromosomes     = atoi(argv[6]);
+   parameters.heterozygosity_rate = atof(argv[7]);
+   parameters.repeat_rate         = atof(argv[8]);
+   parameters.substitution_rate   = atof(argv[9]);
+   parameters.insertion_rate      = atof(argv[10]);
+   parameters.deletion_rate       = atof(argv[11]);
+   parameters.fixed_rate          = atof(argv[12]);
+   parameters.new_error_rate      = atof(argv[13]);
+   parameters.trim_rate           = atof(argv[14]);
+   parameters.seed                = strtoull(argv[15], NULL, 10);
+
+   if (strcmp(argv[2], "illumina") == 0) {
+      parameters.is_pacbio = false;
+   }
+   else if (strcmp(argv[2], "pacbio") == 0) {
+      parameters.is_pacbio = true;
+   }
+   else {
+      std::cout << std::endl << "ERROR: The read type should be illumina or pacbio" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   if ((parameters.num_reads == 0) || (parameters.read_length <= MAX_INSERTION_LENGTH + 1) || (parameters.num_chromosomes <= 0)) {
+      std::cout << std::endl << "ERROR: The number of reads and chromosomes should be > 0 and the read length should be > " << MAX_INSERTION_LENGTH + 1 << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   if ((parameters.substitution_rate + parameters.deletion_rate > 1.0) || (parameters.insertion_rate > 1.0) ||
+       (parameters.heterozygosity_rate > 1.0) || (parameters.repeat_rate > 1.0) ||
+       (parameters.fixed_rate > 1.0) || (parameters.new_error_rate > 1.0) || (parameters.trim_rate > 1.0) ||
+       (parameters.substitution_rate < 0.0) || (parameters.insertion_rate < 0.0) || (parameters.deletion_rate < 0.0) ||
+       (parameters.heterozygosity_rate < 0.0) || (parameters.repeat_rate < 0.0) ||
+       (parameters.fixed_rate < 0.0) || (parameters.new_error_rate < 0.0) || (parameters.trim_rate < 0.0)) {
+      std::cout << std::endl << "ERROR: Rates should be in [0, 1]" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   // every read window should fit in a chromosome with some margin
+   // both mates of a paired read should fit in a chromosome
+   long max_read_length(parameters.is_pacbio ? (long)(parameters.read_length * MAX_LONG_READ_RATIO) : parameters.read_length);
+   long min_chromosome_length(4 * (2 * max_read_length + 100) + (long)(parameters.read_length * INSERT_SIZE_RATIO * 2.0));
+
+   if ((parameters.genome_length / parameters.num_chromosomes) < min_chromosome_length) {
+      std::cout << std::endl << "ERROR: Chromosomes should be longer than " << min_chromosome_length << " bp" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   if (parameters.seed == 0) {
+      std::random_device device;
+
+      parameters.seed = ((unsigned long long)device() << 32) | device();
+   }
+
+   std::mt19937_64 generator(parameters.seed);
+
+   std::cout << std::endl;
+   std::cout << "     Reads             : " << parameters.num_reads << (parameters.is_pacbio ? "" : " pairs") << " x " << parameters.read_length << " bp (" << argv[2] << ")" << std::endl;
+   std::cout << "     Genome            : " << parameters.genome_length << " bp, " << parameters.num_chromosomes << " chromosomes" << std::endl;
+   std::cout << "     Heterozygosity    : " << parameters.heterozygosity_rate << std::endl;
+   std::cout << "     Repeats           : " << parameters.repeat_rate << std::endl;
+   std::cout << "     Errors            : substitution " << parameters.substitution_rate << ", insertion " << parameters.insertion_rate << ", deletion " << parameters.deletion_rate << std::endl;
+   std::cout << "     Corrector         : fixed " << parameters.fixed_rate << ", new errors " << parameters.new_error_rate << ", trimmed " << parameters.trim_rate << std::endl;
+   std::cout << "     Seed              : " << parameters.seed << std::endl << std::endl;
+
+   //--------------------------------------------------
+   // genome
+   //--------------------------------------------------
+   C_genome genome;
+
+   generate_genome(generator, parameters, genome);
+
+   write_genome(parameters.prefix + ".ref-1.fasta", genome.names, genome.chromosomes1);
+   write_genome(parameters.prefix + ".ref-2.fasta", genome.names, genome.chromosomes2);
+
+   //--------------------------------------------------
+   // reads
+   //--------------------------------------------------
+   C_output_files output_files;
+
+   if (parameters.is_pacbio == true) {
+      open_output_file(parameters.prefix + ".fastq",           output_files.f_fastq1);
+      open_output_file(parameters.prefix + ".corrected.fasta", output_files.f_corrected1);
+      open_output_file(parameters.prefix + ".location",        output_files.f_location);
+   }
+   else {
+      open_output_file(parameters.prefix + ".1.fastq",           output_files.f_fastq1);
+      open_output_file(parameters.prefix + ".2.fastq",           output_files.f_fastq2);
+      open_output_file(parameters.prefix + ".corrected.1.fasta", output_files.f_corrected1);
+      open_output_file(parameters.prefix + ".corrected.2.fasta", output_files.f_corrected2);
+      open_output_file(parameters.prefix + ".info",              output_files.f_info);
+   }
+
+   open_output_file(parameters.prefix + ".ref-1.sam", output_files.f_sam1);
+   open_output_file(parameters.prefix + ".ref-2.sam", output_files.f_sam2);
+
+   write_sam_header(output_files.f_sam1, genome);
+   write_sam_header(output_files.f_sam2, genome);
+
+   simulate_reads(generator, parameters, genome, output_files);
+
+   std::cout << "     Simulating reads: done" << std::endl << std::endl;
+}
+
+
+
+//----------------------------------------------------------------------
+// open_output_file
+//----------------------------------------------------------------------
+void open_output_file(const std::string& file_name, std::ofstream& f_out) {
+   f_out.open(file_name.c_str());
+
+   if (f_out.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << file_name << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// generate_genome
+//----------------------------------------------------------------------
+void generate_genome(std::mt19937_64& generator, const C_parameters& parameters, C_genome& genome) {
+   std::uniform_real_distribution<double> probability(0.0, 1.0);
+
+   long chromosome_length(parameters.genome_length / parameters.num_chromosomes);
+
+   long num_snps(0);
+
+   genome.names.resize(parameters.num_chromosomes);
+   genome.chromosomes1.resize(parameters.num_chromosomes);
+   genome.chromosomes2.resize(parameters.num_chromosomes);
+
+   for (int it_chromosome = 0; it_chromosome < parameters.num_chromosomes; it_chromosome++) {
+      genome.names[it_chromosome] = "chr" + std::to_string(it_chromosome + 1);
+
+      generate_chromosome(generator, parameters, chromosome_length, genome.chromosomes1[it_chromosome]);
+
+      // heterozygous snps
+      std::string& chromosome2 = genome.chromosomes2[it_chromosome];
+
+      chromosome2 = genome.chromosomes1[it_chromosome];
+
+      for (long it_base = 0; it_base < chromosome_length; it_base++) {
+         if (probability(generator) < parameters.heterozygosity_rate) {
+            chromosome2[it_base] = random_other_base(generator, chromosome2[it_base]);
+            num_snps++;
+         }
+      }
+   }
+
+   std::cout << "     Generating a diploid genome: done (" << num_snps << " heterozygous snps)" << std::endl;
+}
+
+
+
+//----------------------------------------------------------------------
+// generate_chromosome
+// random bases with homopolymers, tandem repeats, and duplications
+//----------------------------------------------------------------------
+void generate_chromosome(std::mt19937_64& generator, const C_parameters& parameters, const long& length, std::string& chromosome) {
+   std::uniform_real_distribution<double> probability(0.0, 1.0);
+   std::uniform_int_distribution<int>     repeat_type(0, 4);
+
+   chromosome.clear();
+   chromosome.reserve(length + MAX_DUPLICATION_LENGTH);
+
+   while ((long)chromosome.length() < length) {
+      if (probability(generator) < parameters.repeat_rate) {
+         int type(repeat_type(generator));
+
+         // homopolymer
+         if (type < 2) {
+            std::uniform_int_distribution<int> homopolymer_length(MIN_HOMOPOLYMER_LENGTH, MAX_HOMOPOLYMER_LENGTH);
+
+            chromosome.append(homopolymer_length(generator), random_base(generator));
+         }
+         // tandem repeat
+         else if (type < 4) {
+            std::uniform_int_distribution<int> unit_length(MIN_REPEAT_UNIT_LENGTH, MAX_REPEAT_UNIT_LENGTH);
+            std::uniform_int_distribution<int> num_units(MIN_NUM_REPEAT_UNITS, MAX_NUM_REPEAT_UNITS);
+
+            std::string unit;
+
+            for (int it_base = unit_length(generator); it_base > 0; it_base--) {
+               unit.push_back(random_base(generator));
+            }
+
+            for (int it_unit = num_units(generator); it_unit > 0; it_unit--) {
+               chromosome += unit;
+            }
+         }
+         // copy of a previous region with a few differences
+         else if ((long)chromosome.length() > MAX_DUPLICATION_LENGTH) {
+            std::uniform_int_distribution<long> duplication_length(MIN_DUPLICATION_LENGTH, MAX_DUPLICATION_LENGTH);
+
+            long copy_length(duplication_length(generator));
+
+            std::uniform_int_distribution<long> source_index(0, chromosome.length() - copy_length);
+
+            long copy_begin(source_index(generator));
+
+            for (long it_base = copy_begin; it_base < copy_begin + copy_length; it_base++) {
+               if (probability(generator) < DUPLICATION_DIVERGENCE) {
+                  chromosome.push_back(random_other_base(generator, chromosome[it_base]));
+               }
+               else {
+                  chromosome.push_back(chromosome[it_base]);
+               }
+            }
+         }
+      }
+      else {
+         chromosome.push_back(random_base(generator));
+      }
+   }
+
+   chromosome.resize(length);
+}
+
+
+
+//----------------------------------------------------------------------
+// write_genome
+//----------------------------------------------------------------------
+void write_genome(const std::string& file_name, const std::vector<std::string>& names, const std::vector<std::string>& chromosomes) {
+   std::ofstream f_fasta;
+
+   open_output_file(file_name, f_fasta);
+
+   for (std::size_t it_chromosome = 0; it_chromosome < chromosomes.size(); it_chromosome++) {
+      f_fasta << ">" << names[it_chromosome] << "\n";
+
+      for (std::size_t it_base = 0; it_base < chromosomes[it_chromosome].length(); it_base += FASTA_LINE_WIDTH) {
+         f_fasta << chromosomes[it_chromosome].substr(it_base, FASTA_LINE_WIDTH) << "\n";
+      }
+   }
+
+   f_fasta.close();
+}
+
+
+
+//----------------------------------------------------------------------
+// write_sam_header
+//----------------------------------------------------------------------
+void write_sam_header(std::ofstream& f_sam, const C_genome& genome) {
+   f_sam << "@HD\tVN:1.0\tSO:unsorted\n";
+
+   for (std::size_t it_chromosome = 0; it_chromosome < genome.names.size(); it_chromosome++) {
+      f_sam << "@SQ\tSN:" << genome.names[it_chromosome] << "\tLN:" << genome.chromosomes1[it_chromosome].length() << "\n";
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// simulate_reads
+// illumina: a forward read from the 5' end of a fragment and
+//           a reverse read from the 3' end of the fragment
+// pacbio  : a single read from a random strand
+//----------------------------------------------------------------------
+void simulate_reads(std::mt19937_64& generator, const C_parameters& parameters, const C_genome& genome, C_output_files& output_files) {
+   std::uniform_int_distribution<int> chromosome_index(0, parameters.num_chromosomes - 1);
+   std::uniform_int_distribution<int> genome_1_or_2(1, 2);
+   std::uniform_int_distribution<int> strand(0, 1);
+   std::uniform_int_distribution<int> long_read_length((int)(parameters.read_length * MIN_LONG_READ_RATIO), (int)(parameters.read_length * MAX_LONG_READ_RATIO));
+   std::normal_distribution<double>   insert_size(parameters.read_length * INSERT_SIZE_RATIO, parameters.read_length * INSERT_SIZE_SD_RATIO);
+
+   long chromosome_length(parameters.genome_length / parameters.num_chromosomes);
+
+   C_simulated_read read1;
+   C_simulated_read read2;
+
+   for (std::size_t it_read = 0; it_read < parameters.num_reads; it_read++) {
+      int chromosome_id(chromosome_index(generator));
+
+      read1.genome_1_or_2 = genome_1_or_2(generator);
+      read1.chromosome    = genome.names[chromosome_id];
+
+      const std::string& chromosome = (read1.genome_1_or_2 == 1) ? genome.chromosomes1[chromosome_id] : genome.chromosomes2[chromosome_id];
+
+      if (parameters.is_pacbio == true) {
+         int  length(long_read_length(generator));
+         long margin(4 * (2 * length + 100));
+
+         std::uniform_int_distribution<long> anchor(margin, chromosome_length - margin);
+
+         read1.name   = "read_" + std::to_string(it_read + 1);
+         read1.strand = (strand(generator) == 0) ? '+' : '-';
+
+         simulate_read(generator, parameters, chromosome, anchor(generator), length, read1);
+
+         write_read(read1, output_files.f_fastq1, (read1.genome_1_or_2 == 1) ? output_files.f_sam1 : output_files.f_sam2, output_files.corrected_block1);
+         write_location_line(read1, output_files.f_location);
+      }
+      else {
+         int  fragment_length(std::max(parameters.read_length, (int)insert_size(generator)));
+         long margin(4 * (2 * parameters.read_length + 100));
+
+         std::uniform_int_distribution<long> fragment_start(margin, chromosome_length - margin - fragment_length);
+
+         long fragment_begin(fragment_start(generator));
+
+         read2.genome_1_or_2 = read1.genome_1_or_2;
+         read2.chromosome    = read1.chromosome;
+
+         read1.name   = "read_" + std::to_string(it_read + 1) + "/1";
+         read1.strand = '+';
+         read2.name   = "read_" + std::to_string(it_read + 1) + "/2";
+         read2.strand = '-';
+
+         simulate_read(generator, parameters, chromosome, fragment_begin,                       parameters.read_length, read1);
+         simulate_read(generator, parameters, chromosome, fragment_begin + fragment_length - 1, parameters.read_length, read2);
+
+         std::ofstream& f_sam = (read1.genome_1_or_2 == 1) ? output_files.f_sam1 : output_files.f_sam2;
+
+         write_read(read1, output_files.f_fastq1, f_sam, output_files.corrected_block1);
+         write_read(read2, output_files.f_fastq2, f_sam, output_files.corrected_block2);
+
+         write_info_line(read1, fragment_length, output_files.f_info);
+         write_info_line(read2, fragment_length, output_files.f_info);
+      }
+
+      if (output_files.corrected_block1.size() == CORRECTED_BLOCK_SIZE) {
+         flush_corrected_block(generator, output_files.corrected_block1, output_files.f_corrected1);
+      }
+
+      if (output_files.corrected_block2.size() == CORRECTED_BLOCK_SIZE) {
+         flush_corrected_block(generator, output_files.corrected_block2, output_files.f_corrected2);
+      }
+   }
+
+   flush_corrected_block(generator, output_files.corrected_block1, output_files.f_corrected1);
+   flush_corrected_block(generator, output_files.corrected_block2, output_files.f_corrected2);
+}
+
+
+
+//----------------------------------------------------------------------
+// simulate_read
+// errors are added to the reference window to make an original read
+// and the corrector fixes some of them, adds new substitutions, and trims the 3' end
+// anchor (0-based): the first base of the window for the + strand
+//                   the last  base of the window for the - strand
+// no indel is made at the first base or close to the end of the read
+// no insertion is made right after a deletion
+// because pirs info files cannot represent them
+//----------------------------------------------------------------------
+void simulate_read(std::mt19937_64& generator, const C_parameters& parameters, const std::string& chromosome, const long& anchor, const int& length, C_simulated_read& read) {
+   std::uniform_real_distribution<double> probability(0.0, 1.0);
+   std::uniform_int_distribution<int>     insertion_length(1, MAX_INSERTION_LENGTH);
+   std::uniform_int_distribution<int>     trim_length(1, std::max(1, (int)(length * MAX_TRIM_RATIO)));
+
+   // reference sequence in the direction of the read
+   long        window_length_max(2 * length + 100);
+   std::string source;
+
+   if (read.strand == '+') {
+      source = chromosome.substr(anchor, window_length_max);
+   }
+   else {
+      source = chromosome.substr(anchor - window_length_max + 1, window_length_max);
+      reverse_complement(source);
+   }
+
+   read.original_read.clear();
+   read.corrected_read.clear();
+   read.location_substitutions.clear();
+   read.location_insertions.clear();
+   read.location_deletions.clear();
+   read.info_substitutions.clear();
+   read.info_insertions.clear();
+   read.info_deletions.clear();
+
+   // alignment operations of the corrected read (M, I, D)
+   std::string operations;
+
+   long num_inserted_bases(0);
+   long num_deleted_bases(0);
+
+   // read index of the last deletion in the info format
+   long last_deletion_index(-1);
+
+   long window_length(0);
+
+   while (((int)read.original_read.length() < length) && (window_length < (long)source.length())) {
+      char base(source[window_length]);
+
+      window_length++;
+
+      std::string index(std::to_string(window_length));
+
+      bool indel_allowed((window_length > 1) && ((int)read.original_read.length() + 1 + MAX_INSERTION_LENGTH < length));
+      bool is_deletion(false);
+
+      double error_probability(probability(generator));
+
+      // deletion
+      if ((indel_allowed == true) && (error_probability < parameters.deletion_rate)) {
+         long info_index(read.original_read.length());
+
+         read.location_deletions += index + ":" + base + ";";
+
+         // consecutive deletions share the same read index
+         if (info_index == last_deletion_index) {
+            read.info_deletions.insert(read.info_deletions.length() - 1, 1, base);
+         }
+         else {
+            read.info_deletions += std::to_string(info_index) + "," + base + ";";
+         }
+
+         last_deletion_index = info_index;
+         num_deleted_bases++;
+         is_deletion = true;
+
+         if (probability(generator) < parameters.fixed_rate) {
+            read.corrected_read.push_back(base);
+            operations.push_back('M');
+         }
+         else {
+            operations.push_back('D');
+         }
+      }
+      // substitution
+      else if (error_probability < parameters.deletion_rate + parameters.substitution_rate) {
+         char error_base(random_other_base(generator, base));
+
+         read.original_read.push_back(error_base);
+
+         read.location_substitutions += index + ":" + base + "->" + error_base + ";";
+         read.info_substitutions     += std::to_string(read.original_read.length()) + "," + base + "->" + error_base + ";";
+
+         if (probability(generator) < parameters.fixed_rate) {
+            read.corrected_read.push_back(base);
+         }
+         else {
+            read.corrected_read.push_back(error_base);
+         }
+
+         operations.push_back('M');
+      }
+      // no error
+      else {
+         read.original_read.push_back(base);
+
+         // new error made by the corrector
+         if (probability(generator) < parameters.new_error_rate) {
+            read.corrected_read.push_back(random_other_base(generator, base));
+         }
+         else {
+            read.corrected_read.push_back(base);
+         }
+
+         operations.push_back('M');
+      }
+
+      // insertion to the right of this base
+      if ((indel_allowed == true) && (is_deletion == false) && (probability(generator) < parameters.insertion_rate)) {
+         std::string inserted_bases;
+
+         for (int it_inserted = insertion_length(generator); it_inserted > 0; it_inserted--) {
+            inserted_bases.push_back(random_base(generator));
+         }
+
+         read.location_insertions += index + ":" + inserted_bases + ";";
+         read.info_insertions     += std::to_string(read.original_read.length()) + "," + inserted_bases + ";";
+
+         read.original_read += inserted_bases;
+         num_inserted_bases += inserted_bases.length();
+
+         if (probability(generator) >= parameters.fixed_rate) {
+            read.corrected_read += inserted_bases;
+            operations.append(inserted_bases.length(), 'I');
+         }
+      }
+   }
+
+   if (read.location_substitutions.empty() == true) {
+      read.location_substitutions = "-";
+      read.info_substitutions     = "-";
+   }
+
+   if (read.location_insertions.empty() == true) {
+      read.location_insertions = "-";
+      read.info_insertions     = "-";
+   }
+
+   if (read.location_deletions.empty() == true) {
+      read.location_deletions = "-";
+      read.info_deletions     = "-";
+   }
+
+   //--------------------------------------------------
+   // trim the 3' end of the corrected read
+   //--------------------------------------------------
+   if (probability(generator) < parameters.trim_rate) {
+      int num_trimmed_bases(std::min(trim_length(generator), (int)read.corrected_read.length() - 1));
+
+      read.corrected_read.resize(read.corrected_read.length() - num_trimmed_bases);
+
+      while (num_trimmed_bases > 0) {
+         if (operations.back() != 'D') {
+            num_trimmed_bases--;
+         }
+
+         operations.pop_back();
+      }
+   }
+
+   while ((operations.empty() == false) && (operations.back() == 'D')) {
+      operations.pop_back();
+   }
+
+   //--------------------------------------------------
+   // positions
+   //--------------------------------------------------
+   long num_aligned_ref_bases(0);
+
+   for (std::size_t it_operation = 0; it_operation < operations.length(); it_operation++) {
+      if (operations[it_operation] != 'I') {
+         num_aligned_ref_bases++;
+      }
+   }
+
+   if (read.strand == '+') {
+      read.start_index      = anchor + 1;
+      read.info_start_index = read.start_index;
+      read.sam_position     = read.start_index;
+   }
+   else {
+      read.start_index = anchor - window_length + 2;
+
+      // pirs 1.10 has a bug in calculating the start indices of the - strand
+      // convert-info-to-location.dna adds 2 * (insertions - deletions) back
+      read.info_start_index = read.start_index - 2 * (num_inserted_bases - num_deleted_bases);
+      read.sam_position     = anchor + 1 - num_aligned_ref_bases + 1;
+
+      std::reverse(operations.begin(), operations.end());
+   }
+
+   //--------------------------------------------------
+   // cigar
+   //--------------------------------------------------
+   read.cigar.clear();
+
+   for (std::size_t it_operation = 0; it_operation < operations.length(); ) {
+      std::size_t it_end(it_operation);
+
+      while ((it_end < operations.length()) && (operations[it_end] == operations[it_operation])) {
+         it_end++;
+      }
+
+      read.cigar += std::to_string(it_end - it_operation) + operations[it_operation];
+
+      it_operation = it_end;
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// write_read
+// original read: fastq
+// corrected read: fasta (shuffled later) and sam
+//----------------------------------------------------------------------
+void write_read(const C_simulated_read& read, std::ofstream& f_fastq, std::ofstream& f_sam, std::vector<std::string>& corrected_block) {
+   f_fastq << "@" << read.name << "\n" << read.original_read << "\n+\n" << std::string(read.original_read.length(), QUALITY_CHAR) << "\n";
+
+   corrected_block.push_back(">" + read.name + "\n" + read.corrected_read + "\n");
+
+   // <name> <flag> <chromosome> <position> <mapping quality> <cigar> <mate chromosome> <mate position> <insert size> <sequence> <quality>
+   std::string sequence(read.corrected_read);
+
+   if (read.strand == '-') {
+      reverse_complement(sequence);
+   }
+
+   f_sam << read.name << "\t" << ((read.strand == '+') ? 0 : 16) << "\t" << read.chromosome << "\t" << read.sam_position << "\t255\t" << read.cigar << "\t*\t0\t0\t" << sequence << "\t*\n";
+}
+
+
+
+//----------------------------------------------------------------------
+// write_info_line
+// <read name> <genome 1 or 2> <chromosome> <start index> <strand> <insert size> <0> <substitutions> <insertions> <deletions>
+//----------------------------------------------------------------------
+void write_info_line(const C_simulated_read& read, const int& insert_size, std::ofstream& f_info) {
+   f_info << read.name << "\t" << read.genome_1_or_2 << "\t" << read.chromosome << "\t" << read.info_start_index << "\t" << read.strand << "\t" << insert_size << "\t0\t"
+          << read.info_substitutions << "\t" << read.info_insertions << "\t" << read.info_deletions << "\n";
+}
+
+
+
+//----------------------------------------------------------------------
+// write_location_line
+// <read name> <ref 1 or 2> <ref name> <strand> <start index> <read length> <substitutions> <insertions> <deletions>
+//----------------------------------------------------------------------
+void write_location_line(const C_simulated_read& read, std::ofstream& f_location) {
+   f_location << read.name << " " << read.genome_1_or_2 << " " << read.chromosome << " " << read.strand << " " << read.start_index << " " << read.original_read.length() << " "
+              << read.location_substitutions << " " << read.location_insertions << " " << read.location_deletions << "\n";
+}
+
+
+
+//----------------------------------------------------------------------
+// flush_corrected_block
+//----------------------------------------------------------------------
+void flush_corrected_block(std::mt19937_64& generator, std::vector<std::string>& corrected_block, std::ofstream& f_corrected) {
+   std::shuffle(corrected_block.begin(), corrected_block.end(), generator);
+
+   for (std::size_t it_read = 0; it_read < corrected_block.size(); it_read++) {
+      f_corrected << corrected_block[it_read];
+   }
+
+   corrected_block.clear();
+}
+
+
+
+//----------------------------------------------------------------------
+// reverse_complement
+// characters other than A, C, G, and T are not changed
+//----------------------------------------------------------------------
+void reverse_complement(std::string& sequence) {
+   std::size_t length = sequence.length();
+
+   for (std::size_t it_base = 0; it_base < length / 2; it_base++) {
+      std::swap(sequence[it_base], sequence[length - it_base - 1]);
+   }
+
+   for (std::size_t it_base = 0; it_base < length; it_base++) {
+      switch (sequence[it_base]) {
+         case 'A' :
+            sequence[it_base] = 'T';
+            break;
+         case 'C' :
+            sequence[it_base] = 'G';
+            break;
+         case 'G' :
+            sequence[it_base] = 'C';
+            break;
+         case 'T' :
+            sequence[it_base] = 'A';
+            break;
+      }
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// random_base
+//----------------------------------------------------------------------
+char random_base(std::mt19937_64& generator) {
+   return "ACGT"[generator() & 3];
+}
+
+
+
+//----------------------------------------------------------------------
+// random_other_base
+//----------------------------------------------------------------------
+char random_other_base(std::mt19937_64& generator, const char& base) {
+   char other_base;
+
+   do {
+      other_base = random_base(generator);
+   } while (other_base == base);
+
+   return other_base;
+}
@@ -0,0 +1,527 @@
+// CONTACT: yunheo1@illinois.edu
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <zlib.h>
+#include "read-file.h"
+
+// size of a block handed to an output thread
+#define OUTPUT_BLOCK_SIZE 4194304
+
+// maximum number of blocks waiting to be written per output file
+#define MAX_QUEUED_BLOCKS 4
+
+// progress is printed every this number of read pairs
+#define PROGRESS_INTERVAL 100000
+
+
+
+//----------------------------------------------------------------------
+// buffered output file
+// each output file has its own thread that compresses (optional) and writes
+// the blocks, so the main thread only copies reads into the buffer
+// compressed blocks are independent gzip members
+// and their concatenation is a valid gzip file
+//----------------------------------------------------------------------
+class C_output_writer {
+   private:
+      FILE* f_out;
+
+      std::string file_name;
+
+      bool gzip;
+
+      std::string buffer;
+
+      std::deque<std::string> blocks;
+      bool                    closed;
+
+      std::mutex              queue_mutex;
+      std::condition_variable queue_cond;
+
+      std::thread writer;
+
+      void write_blocks();
+      void flush_buffer();
+      void compress_block(const std::string& block, std::string& compressed);
+
+   public:
+      C_output_writer(const std::string& in_file_name, const bool& in_gzip);
+
+      void write(const std::string& text) {
+         buffer += text;
+
+         if (buffer.length() >= OUTPUT_BLOCK_SIZE) {
+            flush_buffer();
+         }
+      }
+
+      void close();
+};
+
+
+
+struct C_location_pair {
+   std::string read_name1;
+   std::string read_name2;
+   char        genome;
+};
+
+
+
+bool is_location_line(const std::string& line, std::string& read_name, char& genome);
+bool is_na_line(const std::string& line);
+char detect_format(const char* read_file_name);
+void write_read(C_output_writer& writer, const C_read_file& read_file, const std::string& read_name, const bool& is_fastq);
+
+
+
+int main (int argc, char** argv) {
+   // check the number of arguments
+   if (argc != 7) {
+      std::cout << std::endl << "USAGE: " << argv[0] << " <location file> <forward read file> <reverse read file> <fasta|fastq|auto> <output prefix> <Y|N: gzip output>" << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   // input format
+   bool is_fastq;
+
+   std::string input_format(argv[4]);
+
+   if (input_format == "auto") {
+      input_format = (detect_format(argv[2]) == '@') ? "fastq" : "fasta";
+
+      std::cout << "     Detected input format: " << input_format << std::endl;
+   }
+
+   if (input_format == "fastq") {
+      is_fastq = true;
+   }
+   else if (input_format == "fasta") {
+      is_fastq = false;
+   }
+   else {
+      std::cout << std::endl << "ERROR: The input file format should be fastq or fasta " << input_format << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   bool gzip = (strcmp(argv[6], "Y") == 0);
+
+   // output files
+   std::string prefix(argv[5]);
+   std::string extension("." + input_format);
+
+   if (gzip == true) {
+      extension += ".gz";
+   }
+
+   // open files
+   std::ifstream f_location(argv[1]);
+
+   if (f_location.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << argv[1] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   C_read_file forward_file(argv[2], is_fastq);
+   C_read_file reverse_file(argv[3], is_fastq);
+
+   C_output_writer out_genome_a_1(prefix + ".genome-a.1" + extension, gzip);
+   C_output_writer out_genome_a_2(prefix + ".genome-a.2" + extension, gzip);
+   C_output_writer out_genome_b_1(prefix + ".genome-b.1" + extension, gzip);
+   C_output_writer out_genome_b_2(prefix + ".genome-b.2" + extension, gzip);
+
+   //--------------------------------------------------
+   // iterate location lines
+   //--------------------------------------------------
+   std::string line_location1;
+   std::string line_location2;
+
+   std::size_t num_pairs = 0;
+
+   while (std::getline(f_location, line_location1)) {
+      std::string read_name1;
+      std::string read_name2;
+      char        genome1;
+      char        genome2;
+
+      // <read name> <ref 1 or 2> <ref name> <strand> <start index> <read length> <substitutions> <insertions> <deletions>
+      if (is_location_line(line_location1, read_name1, genome1) == true) {
+         // take the next location line
+         if (!std::getline(f_location, line_location2)) {
+            std::cout << std::endl << "ERROR: The number of reads in " << argv[1] << " is not even" << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         if (is_location_line(line_location2, read_name2, genome2) == false) {
+            std::cout << std::endl << "ERROR: Wrong line " << line_location2 << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         // compare two read names without /1 and /2
+         std::string read_name1_tmp(read_name1);
+         std::string read_name2_tmp(read_name2);
+
+         if ((read_name1_tmp.length() >= 2) && (read_name1_tmp.compare(read_name1_tmp.length() - 2, 2, "/1") == 0)) {
+            read_name1_tmp.erase(read_name1_tmp.length() - 2);
+         }
+
+         if ((read_name2_tmp.length() >= 2) && (read_name2_tmp.compare(read_name2_tmp.length() - 2, 2, "/2") == 0)) {
+            read_name2_tmp.erase(read_name2_tmp.length() - 2);
+         }
+
+         if (read_name1_tmp != read_name2_tmp) {
+            std::cout << std::endl << "ERROR: Read names are not matched " << read_name1 << " vs " << read_name2 << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         // compare genomes
+         if (genome1 != genome2) {
+            std::cout << std::endl << "ERROR: Genomes are not matched " << genome1 << " vs " << genome2 << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         // take reads
+         if (forward_file.next_read() == false) {
+            std::cout << std::endl << "ERROR: The number of reads in " << argv[1] << " is not matched with that in " << argv[2] << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         if (reverse_file.next_read() == false) {
+            std::cout << std::endl << "ERROR: The number of reads in " << argv[1] << " is not matched with that in " << argv[3] << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         // write the reads with the original names
+         if (genome1 == '1') {
+            write_read(out_genome_a_1, forward_file, read_name1, is_fastq);
+            write_read(out_genome_a_2, reverse_file, read_name2, is_fastq);
+         }
+         else {
+            write_read(out_genome_b_1, forward_file, read_name1, is_fastq);
+            write_read(out_genome_b_2, reverse_file, read_name2, is_fastq);
+         }
+
+         num_pairs++;
+
+         if ((num_pairs % PROGRESS_INTERVAL) == 0) {
+            printf("     %12zu lines processed\n", num_pairs);
+         }
+      }
+      // N/A pairs
+      // the reads are skipped in both the read files
+      else if (is_na_line(line_location1) == true) {
+         if ((!std::getline(f_location, line_location2)) || (is_na_line(line_location2) == false)) {
+            std::cout << std::endl << "ERROR: Wrong location line " << line_location2 << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         if (forward_file.next_read() == false) {
+            std::cout << std::endl << "ERROR: The number of reads in " << argv[1] << " is not matched with that in " << argv[2] << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+
+         if (reverse_file.next_read() == false) {
+            std::cout << std::endl << "ERROR: The number of reads in " << argv[1] << " is not matched with that in " << argv[3] << std::endl << std::endl;
+            exit(EXIT_FAILURE);
+         }
+      }
+      else {
+         std::cout << std::endl << "ERROR: Wrong location line " << line_location1 << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+   }
+
+   // check if remaining lines exist in read files
+   if (forward_file.is_eof() == false) {
+      std::cout << std::endl << "ERROR: The number of lines in " << argv[1] << " is not matched with that in " << argv[2] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   if (reverse_file.is_eof() == false) {
+      std::cout << std::endl << "ERROR: The number of lines in " << argv[1] << " is not matched with that in " << argv[3] << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   f_location.close();
+
+   out_genome_a_1.close();
+   out_genome_a_2.close();
+   out_genome_b_1.close();
+   out_genome_b_2.close();
+
+   printf("     Number of read pairs: %12zu\n", num_pairs);
+}
+
+
+
+//----------------------------------------------------------------------
+// is_location_line
+// <read name> <ref 1 or 2> <ref name> <strand> <start index> <read length> <substitutions> <insertions> <deletions>
+//----------------------------------------------------------------------
+bool is_location_line(const std::string& line, std::string& read_name, char& genome) {
+   if ((line.empty() == true) || isspace(line[0])) {
+      return false;
+   }
+
+   std::vector<std::string> fields;
+
+   std::size_t it_begin = 0;
+
+   while ((it_begin < line.length()) && (fields.size() < 9)) {
+      std::size_t it_end = it_begin;
+
+      while ((it_end < line.length()) && (isspace(line[it_end]) == false)) {
+         it_end++;
+      }
+
+      fields.push_back(line.substr(it_begin, it_end - it_begin));
+
+      it_begin = it_end;
+
+      while ((it_begin < line.length()) && isspace(line[it_begin])) {
+         it_begin++;
+      }
+   }
+
+   if ((fields.size() < 9) ||
+       ((fields[1] != "1") && (fields[1] != "2")) ||
+       ((fields[3] != "+") && (fields[3] != "-")) ||
+       (fields[4].find_first_not_of("0123456789-") != std::string::npos) ||
+       (fields[5].find_first_not_of("0123456789") != std::string::npos)) {
+      return false;
+   }
+
+   read_name = fields[0];
+   genome    = fields[1][0];
+
+   return true;
+}
+
+
+
+//----------------------------------------------------------------------
+// is_na_line
+// <read name> N/A
+//----------------------------------------------------------------------
+bool is_na_line(const std::string& line) {
+   if ((line.empty() == true) || isspace(line[0])) {
+      return false;
+   }
+
+   std::size_t it_space = line.find_first_of(" \t\r\f\v");
+
+   if (it_space == std::string::npos) {
+      return false;
+   }
+
+   std::size_t it_na = line.find_first_not_of(" \t\r\f\v", it_space);
+
+   return ((it_na != std::string::npos) && (line.compare(it_na, 3, "N/A") == 0));
+}
+
+
+
+//----------------------------------------------------------------------
+// detect_format
+// the first character of a read file: '>' for fasta and '@' for fastq
+//----------------------------------------------------------------------
+char detect_format(const char* read_file_name) {
+   std::ifstream f_read(read_file_name);
+
+   if (f_read.is_open() == false) {
+      std::cout << std::endl << "ERROR: Cannot open " << read_file_name << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   int first_char = f_read.get();
+
+   f_read.close();
+
+   if ((first_char != '>') && (first_char != '@')) {
+      std::cout << std::endl << "ERROR: Cannot detect the format of " << read_file_name << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   return (char)first_char;
+}
+
+
+
+//----------------------------------------------------------------------
+// write_read
+// the header is replaced with the read name in the location file
+//----------------------------------------------------------------------
+void write_read(C_output_writer& writer, const C_read_file& read_file, const std::string& read_name, const bool& is_fastq) {
+   std::string record;
+
+   record.reserve(read_name.length() + read_file.line_sequence.length() * 2 + read_file.line_plus.length() + 8);
+
+   record += is_fastq ? "@" : ">";
+   record += read_name;
+   record += "\n";
+   record += read_file.line_sequence;
+   record += "\n";
+
+   if (is_fastq == true) {
+      record += read_file.line_plus;
+      record += "\n";
+      record += read_file.line_quality;
+      record += "\n";
+   }
+
+   writer.write(record);
+}
+
+
+
+//----------------------------------------------------------------------
+// C_output_writer::C_output_writer
+//----------------------------------------------------------------------
+C_output_writer::C_output_writer(const std::string& in_file_name, const bool& in_gzip) :
+   file_name(in_file_name),
+   gzip(in_gzip),
+   closed(false) {
+   f_out = fopen(file_name.c_str(), "wb");
+
+   if (f_out == NULL) {
+      std::cout << std::endl << "ERROR: Cannot open " << file_name << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   buffer.reserve(OUTPUT_BLOCK_SIZE + OUTPUT_BLOCK_SIZE / 4);
+
+   writer = std::thread(&C_output_writer::write_blocks, this);
+}
+
+
+
+//----------------------------------------------------------------------
+// C_output_writer::flush_buffer
+// hands the buffer to the output thread
+//----------------------------------------------------------------------
+void C_output_writer::flush_buffer() {
+   if (buffer.empty() == true) {
+      return;
+   }
+
+   std::unique_lock<std::mutex> lock(queue_mutex);
+
+   while (blocks.size() >= MAX_QUEUED_BLOCKS) {
+      queue_cond.wait(lock);
+   }
+
+   blocks.push_back(std::string());
+   blocks.back().swap(buffer);
+
+   buffer.reserve(OUTPUT_BLOCK_SIZE + OUTPUT_BLOCK_SIZE / 4);
+
+   queue_cond.notify_all();
+}
+
+
+
+//----------------------------------------------------------------------
+// C_output_writer::close
+//----------------------------------------------------------------------
+void C_output_writer::close() {
+   flush_buffer();
+
+   {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+
+      closed = true;
+
+      queue_cond.notify_all();
+   }
+
+   writer.join();
+
+   fclose(f_out);
+}
+
+
+
+//----------------------------------------------------------------------
+// C_output_writer::write_blocks
+// runs in the output thread
+//----------------------------------------------------------------------
+void C_output_writer::write_blocks() {
+   std::string block;
+   std::string compressed;
+
+   while (true) {
+      {
+         std::unique_lock<std::mutex> lock(queue_mutex);
+
+         while ((blocks.empty() == true) && (closed == false)) {
+            queue_cond.wait(lock);
+         }
+
+         if (blocks.empty() == true) {
+            return;
+         }
+
+         block.swap(blocks.front());
+         blocks.pop_front();
+
+         queue_cond.notify_all();
+      }
+
+      const std::string* out_block = &block;
+
+      if (gzip == true) {
+         compress_block(block, compressed);
+         out_block = &compressed;
+      }
+
+      if (fwrite(out_block->data(), 1, out_block->length(), f_out) != out_block->length()) {
+         std::cout << std::endl << "ERROR: Cannot write to " << file_name << std::endl << std::endl;
+         exit(EXIT_FAILURE);
+      }
+   }
+}
+
+
+
+//----------------------------------------------------------------------
+// C_output_writer::compress_block
+// a block is compressed into a gzip member
+//----------------------------------------------------------------------
+void C_output_writer::compress_block(const std::string& block, std::string& compressed) {
+   z_stream stream;
+
+   memset(&stream, 0, sizeof(stream));
+
+   // 15 + 16: gzip header and trailer
+   if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+      std::cout << std::endl << "ERROR: Cannot initialize zlib for " << file_name << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   compressed.resize(deflateBound(&stream, block.length()));
+
+   stream.next_in   = (Bytef*)block.data();
+   stream.avail_in  = block.length();
+   stream.next_out  = (Bytef*)&compressed[0];
+   stream.avail_out = compressed.length();
+
+   if (deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+      std::cout << std::endl << "ERROR: Cannot compress a block of " << file_name << std::endl << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
+   compressed.resize(stream.total_out);
+
+   deflateEnd(&stream);
+}